@@ -0,0 +1,137 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Implementation of the adaptive integrator							*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "Adaptive_Integrator.h"
+
+/****************************************************************************************************/
+/*										 	Construction 											*/
+/****************************************************************************************************/
+Adaptive_Integrator::Adaptive_Integrator(Cortical_Column& Cortex, CA3_Column& CA3, double atol, double rtol,
+										 int max_level)
+	: Cortex(Cortex), CA3(CA3), atol(atol), rtol(rtol), max_level(max_level) {
+	if (atol < 0 || rtol < 0 || atol + rtol <= 0) {
+		throw std::invalid_argument("Adaptive_Integrator: invalid tolerances");
+	}
+	if (max_level < 0 || (1 << max_level) > PSP_Propagator::max_substeps) {
+		throw std::invalid_argument("Adaptive_Integrator: invalid maximal level");
+	}
+	P_C.resize(max_level+1);
+	P_H.resize(max_level+1);
+	for (int l=0; l<=max_level; ++l) {
+		Cortex.set_propagators(P_C[l], 1 << l);
+		CA3.set_propagators(P_H[l], 1 << l);
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Step control 											*/
+/****************************************************************************************************/
+int Adaptive_Integrator::step(long limit, double* frame) {
+	/* The columns are held by value, the copy includes the position of the noise streams */
+	const Cortical_Column	C_start	= Cortex;
+	const CA3_Column		H_start	= CA3;
+	while (true) {
+		while ((1L << level) > limit) {
+			--level;
+		}
+		Cortex.exp_step(P_C[level]);
+		CA3.exp_step(P_H[level]);
+
+		/* Largest error relative to the tolerance */
+		double error[3];
+		Cortex.get_error(error);
+		CA3.get_error(error+1, error+2);
+		Cortex.get_data(0, frame);
+		CA3.get_data(0, frame+1, frame+2);
+		double ratio = 0.0;
+		for (int c=0; c<3; ++c) {
+			ratio = std::max(ratio, std::abs(error[c]) / (atol + rtol * std::abs(frame[c])));
+		}
+
+		/* Steps of dt are always accepted, there is no finer level of the noise */
+		if (ratio > 1.0 && level > 0) {
+			Cortex	= C_start;
+			CA3		= H_start;
+			--level;
+			++n_rejected;
+			continue;
+		}
+
+		/* The local error of the predictor, and so the estimate, grows by 2^2 with the step length.	*/
+		/* The next step is doubled if its estimate is expected below 0.4 of the tolerance				*/
+		const int k = 1 << level;
+		if (ratio < 0.1 && level < max_level) {
+			++level;
+		}
+		++n_accepted;
+		n_steps += k;
+		return k;
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Resampling	 											*/
+/****************************************************************************************************/
+void Adaptive_Integrator::run(long n, int stride, const std::function<void(const double*)>& out) {
+	double start[3], end[3], frame[3];
+	Cortex.get_data(0, start);
+	CA3.get_data(0, start+1, start+2);
+	long t = 0;
+	while (t < n) {
+		const int k = step(n - t, end);
+
+		/* Output steps within (t, t+k] */
+		for (long i = t + stride - t % stride; i <= t + k; i += stride) {
+			const double w = (double) (i - t) / k;
+			for (int c=0; c<3; ++c) {
+				frame[c] = start[c] + w * (end[c] - start[c]);
+			}
+			out(frame);
+		}
+		std::copy(end, end+3, start);
+		t += k;
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
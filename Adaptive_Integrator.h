@@ -0,0 +1,96 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Adaptive exponential integration									*/
+/*																									*/
+/*		The columns are advanced with the exponential integrator in steps of 2^level * dt. The		*/
+/*		difference of corrector and predictor of every step is an embedded estimate of its error,	*/
+/*		as it only stems from the change of the firing rates during the step. Steps with an error	*/
+/*		above the tolerance are rejected and repeated with half the length, steps well below it		*/
+/*		double the length of the next step. So bursts get short steps and quiescent phases long		*/
+/*		ones.																						*/
+/*																									*/
+/*		The noise of the model is defined per step of dt and drawn from counter based streams, so	*/
+/*		it forms a Brownian tree with dt as finest level: every step of k*dt consumes the draws of	*/
+/*		its k substeps, and a rejected step restores the columns including their streams, so the	*/
+/*		repeated step sees the same noise. The output is resampled onto the uniform grid of dt.		*/
+/****************************************************************************************************/
+#pragma once
+#include <functional>
+#include <vector>
+#include "CA3_Column.h"
+#include "Cortical_Column.h"
+using std::vector;
+
+/****************************************************************************************************/
+/*									Implementation of the integrator								*/
+/****************************************************************************************************/
+class Adaptive_Integrator {
+public:
+	/* Steps of at most 2^max_level * dt. A step is accepted if the error of every output channel	*/
+	/* (V_C, V_H, Y_H) is below atol + rtol * |value|. Throws std::invalid_argument for negative	*/
+	/* or vanishing tolerances or if 2^max_level exceeds PSP_Propagator::max_substeps				*/
+	Adaptive_Integrator(Cortical_Column& Cortex, CA3_Column& CA3, double atol, double rtol = 0.0,
+						int max_level = 4);
+
+	/* Advances by one accepted step of at most limit steps of dt, returns its length in steps of	*/
+	/* dt. frame receives the output (V_C, V_H, Y_H) at the end of the step						*/
+	int		step		(long limit, double* frame);
+
+	/* Integrates n steps of dt and passes the frame (V_C, V_H, Y_H) of every stride-th step of dt	*/
+	/* to out, linearly interpolated between the accepted steps									*/
+	void	run			(long n, int stride, const std::function<void(const double*)>& out);
+
+	/* Statistics of the steps so far */
+	long	accepted	(void) const {return n_accepted;}
+	long	rejected	(void) const {return n_rejected;}
+	double	mean_step	(void) const {return n_accepted ? (double) n_steps / n_accepted : 0.0;}
+
+private:
+	Cortical_Column&	Cortex;
+	CA3_Column&			CA3;
+	const double		atol;
+	const double		rtol;
+	const int			max_level;
+
+	/* Propagators of every level */
+	vector<Cortical_Column::Propagators>	P_C;
+	vector<CA3_Column::Propagators>			P_H;
+
+	/* Level of the next step */
+	int		level		= 0;
+
+	long	n_accepted	= 0;
+	long	n_rejected	= 0;
+	long	n_steps		= 0;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
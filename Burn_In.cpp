@@ -0,0 +1,255 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Implementation of the burn-in cache								*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include "Burn_In.h"
+#include "ODE.h"
+#include "Sigmoid.h"
+#include "Snapshot.h"
+
+static const char		burn_in_magic[8]	= {'N', 'M', 'H', 'F', 'O', 'B', 'R', 'N'};
+static const uint32_t	burn_in_version		= 1;
+
+/* The burn-in noise uses its own key, so it never coincides with the noise of a run */
+static const uint64_t	burn_in_seed		= 0x4255524E494E0000ull;
+
+/****************************************************************************************************/
+/*										 	Parameters 												*/
+/****************************************************************************************************/
+/* Canonical description of a parameter set, independent of the order of different parameters.	*/
+/* A parameter given repeatedly enters with its last value, as it is applied. The sigmoid kernel	*/
+/* is part of the key, as the burned in states differ in the last bits between the kernels		*/
+static std::string make_key(const Parameter_Set& params, int onset) {
+	extern const double dt;
+	const std::map<std::string, double> sorted(params.rbegin(), params.rend());
+
+	char buffer[128];
+	std::snprintf(buffer, sizeof(buffer), "onset=%d;dt=%.17g;sigmoid=%s", onset, dt,
+				  sigmoid_mode_name(get_sigmoid_mode()));
+	std::string key(buffer);
+	for (const auto& p : sorted) {
+		std::snprintf(buffer, sizeof(buffer), "=%.17g", p.second);
+		key += ";" + p.first + buffer;
+	}
+	return key;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+Burn_In_Cache::Burn_In_Cache(const std::string& directory, int states, double decorrelation)
+: directory		(directory),
+  states		(std::max(states, 1)),
+  decorrelation	(std::max(decorrelation, 0.0)),
+  created		(0),
+  read			(0)
+{}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Start of a run 											*/
+/****************************************************************************************************/
+void Burn_In_Cache::start(Cortical_Column& Cortex, CA3_Column& CA3, const Parameter_Set& params,
+						  int onset, uint64_t seed, uint32_t realization) {
+	extern const int res;
+	if (!apply_params(params, Cortex, CA3)) {
+		throw std::runtime_error("Burn_In_Cache: unknown parameter");
+	}
+	const Entry& e = entry(make_key(params, onset), params, onset);
+
+	/* The snapshot only restores input and the connectivities, all other parameters were applied	*/
+	/* above. Then the run gets its own noise														*/
+	std::istringstream in(e.states[realization % e.states.size()]);
+	Cortex.load(in);
+	CA3.load(in);
+	Cortex.set_RNG(seed, realization);
+	CA3.set_RNG(seed, realization);
+
+	for (int t=0; t<decorrelation*res; ++t) {
+		ODE(Cortex, CA3);
+	}
+}
+
+Burn_In_Cache::Entry& Burn_In_Cache::entry(const std::string& key, const Parameter_Set& params, int onset) {
+	extern const int res;
+	Entry* e;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		std::unique_ptr<Entry>& slot = entries[key];
+		if (!slot) {
+			slot.reset(new Entry);
+		}
+		e = slot.get();
+	}
+
+	/* Only the first user of a key creates the states, different keys proceed in parallel */
+	std::lock_guard<std::mutex> guard(e->lock);
+	if (e->ready) {
+		return *e;
+	}
+	if (read_file(key, *e)) {
+		++read;
+	} else {
+		e->states.clear();
+		for (int i=0; i<states; ++i) {
+			Cortical_Column Cortex(burn_in_seed, UINT32_MAX - i);
+			CA3_Column		CA3(burn_in_seed, UINT32_MAX - i);
+			apply_params(params, Cortex, CA3);
+			for (int t=0; t<onset*res; ++t) {
+				ODE(Cortex, CA3);
+			}
+			std::ostringstream out;
+			Cortex.save(out);
+			CA3.save(out);
+			e->states.push_back(out.str());
+		}
+		created += states;
+		write_file(key, *e);
+	}
+	e->ready = true;
+	return *e;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Cache files 											*/
+/****************************************************************************************************/
+/* FNV-1a hash of the key as file name, the key itself is stored in the file */
+std::string Burn_In_Cache::file(const std::string& key) const {
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (unsigned char c : key) {
+		hash = (hash ^ c) * 0x100000001B3ull;
+	}
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.burnin", (unsigned long long) hash);
+	return directory + "/" + name;
+}
+
+bool Burn_In_Cache::read_file(const std::string& key, Entry& e) {
+	if (directory.empty()) {
+		return false;
+	}
+	std::ifstream in(file(key), std::ios::binary);
+	if (!in) {
+		return false;
+	}
+
+	/* Stale, foreign or damaged files are recreated */
+	try {
+		Snapshot_Reader ar{in};
+		char		magic[8];
+		uint32_t	version, length, count;
+		if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, burn_in_magic, sizeof(magic))) {
+			return false;
+		}
+		ar(version);
+		ar(length);
+		if (version != burn_in_version || length != key.size()) {
+			return false;
+		}
+		std::string stored(length, '\0');
+		if (!in.read(&stored[0], length) || stored != key) {
+			return false;
+		}
+		ar(count);
+		if ((int) count < states) {
+			return false;
+		}
+
+		/* Parse every state once to find its extent */
+		e.states.clear();
+		for (int i=0; i<states; ++i) {
+			const std::streampos begin = in.tellg();
+			Cortical_Column Cortex(0);
+			CA3_Column		CA3(0);
+			Cortex.load(in);
+			CA3.load(in);
+			std::string state(in.tellg() - begin, '\0');
+			in.seekg(begin);
+			in.read(&state[0], state.size());
+			e.states.push_back(state);
+		}
+	} catch (const std::runtime_error&) {
+		return false;
+	}
+	return true;
+}
+
+void Burn_In_Cache::write_file(const std::string& key, const Entry& e) const {
+	if (directory.empty()) {
+		return;
+	}
+
+	/* Written under a temporary name, so concurrent processes never read a partial file */
+	const std::string name = file(key);
+	const std::string temp = name + ".tmp" + std::to_string(getpid());
+	{
+		std::ofstream out(temp, std::ios::binary);
+		Snapshot_Writer ar{out};
+		const uint32_t length = key.size();
+		const uint32_t count  = e.states.size();
+		out.write(burn_in_magic, sizeof(burn_in_magic));
+		ar(burn_in_version);
+		ar(length);
+		out.write(key.data(), length);
+		ar(count);
+		for (const std::string& state : e.states) {
+			out.write(state.data(), state.size());
+		}
+		if (!out) {
+			throw std::runtime_error("Burn_In_Cache: cannot write " + temp);
+		}
+	}
+	if (std::rename(temp.c_str(), name.c_str())) {
+		std::remove(temp.c_str());
+		throw std::runtime_error("Burn_In_Cache: cannot write " + name);
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,103 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Cache of burned in states									*/
+/*																									*/
+/*		Every run starts with an onset that only removes the transient from the resting state.		*/
+/*		The cache keeps a number of independent post-transient states per parameter set, stored	*/
+/*		as snapshots in a directory, so the onset is integrated once per state instead of once		*/
+/*		per run. A run continues from one of these states with its own noise realization and an		*/
+/*		optional short decorrelation. The states are created on the first request of a key.		*/
+/*																									*/
+/*		File layout:	char[8] magic "NMHFOBRN", uint32 version, uint32 key length, key,			*/
+/*						uint32 number of states, every state as cortex and CA3 snapshot				*/
+/****************************************************************************************************/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "CA3_Column.h"
+#include "Cortical_Column.h"
+#include "Parameters.h"
+using std::vector;
+
+/****************************************************************************************************/
+/*										Implementation of the cache									*/
+/****************************************************************************************************/
+class Burn_In_Cache {
+public:
+	/* Constructors. With an empty directory the states are only kept in memory. Every key holds	*/
+	/* states independent states, runs are decorrelated for decorrelation s after the start		*/
+	explicit Burn_In_Cache(const std::string& directory = "", int states = 8, double decorrelation = 1.0);
+
+	/* Apply the parameters and continue from the burned in state realization % states with the		*/
+	/* noise realization (seed, realization). Throws std::runtime_error for unknown parameters		*/
+	/* or if the cache file cannot be written. May be called concurrently						*/
+	void	start	(Cortical_Column& Cortex, CA3_Column& CA3, const Parameter_Set& params, int onset,
+					 uint64_t seed, uint32_t realization);
+
+	/* Number of states that had to be integrated and that were read from disk */
+	int		computed	(void) const {return created.load();}
+	int		loaded		(void) const {return read.load();}
+
+private:
+	/* Burned in states of a single key, every state is the snapshot of both columns */
+	struct Entry {
+		std::mutex					lock;
+		bool						ready	= false;
+		vector<std::string>			states;
+	};
+
+	/* Entry of a key, filled from disk or by integration on first use */
+	Entry&	entry		(const std::string& key, const Parameter_Set& params, int onset);
+
+	/* Read or write the states of a key, read returns false if the file is missing or stale */
+	bool	read_file	(const std::string& key, Entry& e);
+	void	write_file	(const std::string& key, const Entry& e) const;
+
+	/* File name of a key */
+	std::string	file	(const std::string& key) const;
+
+	const std::string	directory;
+	const int			states;
+	const double		decorrelation;
+
+	std::mutex										lock;
+	std::map<std::string, std::unique_ptr<Entry>>	entries;
+	std::atomic<int>								created;
+	std::atomic<int>								read;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -30,28 +30,143 @@
 /****************************************************************************************************/
 /*									Functions of the CA3 module										*/
 /****************************************************************************************************/
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include "CA3_Column.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+
+/* The state is held by value, so columns can be copied as plain memory */
+static_assert(std::is_trivially_copyable<CA3_Column>::value, "CA3_Column must be trivially copyable");
+
+/* Parameters for SRK4 iteration */
+constexpr double CA3_Column::A[4];
+constexpr double CA3_Column::B[4];
 
 /****************************************************************************************************/
 /*										 Initialization of RNG 										*/
 /****************************************************************************************************/
 void CA3_Column::set_RNG(void) {
-	extern const double dt;
-	/* Number of independent random variables */
-	int N = 2;
+	set_RNG(rand(), 0);
+}
 
+/* Reproducible initialization, the streams are keyed by (seed, realization, column, stream) */
+void CA3_Column::set_RNG(uint64_t seed, uint32_t realization) {
+	extern const double dt;
 	/* Create RNG for each stream */
-	for (int i=0; i<N; ++i){
+	for (int i=0; i<N_noise/2; ++i){
 		/* Add the RNG for I_{l}*/
-		MTRands.push_back(random_stream_normal(0.0, dphi*dt));
+		Rands[2*i]	 = random_stream_philox(0.0, dphi*dt, seed, realization, RNG_CA3, 2*i);
 
 		/* Add the RNG for I_{l,0} */
-		MTRands.push_back(random_stream_normal(0.0, dt));
+		Rands[2*i+1] = random_stream_philox(0.0, dt, seed, realization, RNG_CA3, 2*i+1);
+	}
+
+	/* Get the random number for the first iteration */
+	fill_noise();
+	for (int i=0; i<N_noise; ++i) {
+		Rand_vars[i] = Noise[i*noise_block];
+	}
+	noise_pos = 1;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Parameter access 											*/
+/****************************************************************************************************/
+bool CA3_Column::set_param(const std::string& name, double value) {
+	typedef CA3_Column H;
+	static const std::pair<const char*, double H::*> params[] = {
+		{"tau_p",	&H::tau_p},		{"tau_f",	&H::tau_f},		{"Qp_max",	&H::Qp_max},
+		{"Qf_max",	&H::Qf_max},	{"theta_p",	&H::theta_p},	{"theta_f",	&H::theta_f},
+		{"sigma_p",	&H::sigma_p},	{"sigma_f",	&H::sigma_f},	{"gamma_p",	&H::gamma_p},
+		{"gamma_fA",&H::gamma_fA},	{"G_p",		&H::G_p},		{"G_fA",	&H::G_fA},
+		{"g_L",		&H::g_L},		{"E_AMPA",	&H::E_AMPA},	{"E_GABA",	&H::E_GABA},
+		{"E_L",		&H::E_L},		{"dphi",	&H::dphi},		{"input",	&H::input},
+		{"N_pp",	&H::N_pp},		{"N_pf",	&H::N_pf},		{"N_fp",	&H::N_fp},
+		{"N_ff",	&H::N_ff}};
+	for (const auto& p : params) {
+		if (name == p.first) {
+			this->*p.second = value;
+			refresh_param(name);
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Updates the state that depends on a parameter */
+void CA3_Column::refresh_param(const std::string& name) {
+	if (name == "dphi") {
+		set_RNG(Rands[0].seed, Rands[0].realization);
+	}
+	if (Exp[0].substeps() > 0 && (name.compare(0, 6, "gamma_") == 0 || name.compare(0, 2, "G_") == 0)) {
+		set_exponential(Exp[0].substeps());
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	State snapshots 										*/
+/****************************************************************************************************/
+/* Only the first SRK moment is stored, the others are overwritten before they are used */
+template <typename Archive, typename Column>
+void CA3_Column::snapshot_fields(Archive& ar, Column& c) {
+	ar(c.V_p[0]);
+	ar(c.V_f[0]);
+	ar(c.y_pp[0]);
+	ar(c.y_pf[0]);
+	ar(c.y_fA[0]);
+	ar(c.x_pp[0]);
+	ar(c.x_pf[0]);
+	ar(c.x_fA[0]);
+	for (int i=0; i<N_noise; ++i) {
+		ar(c.Rand_vars[i]);
+	}
+	ar(c.input);
+	ar(c.N_pp);
+	ar(c.N_pf);
+	ar(c.N_fp);
+	ar(c.N_ff);
+}
+
+void CA3_Column::save(std::ostream& out) const {
+	Snapshot_Writer ar{out};
+	write_snapshot_header(ar, RNG_CA3, Rands[0].seed, Rands[0].realization, N_noise);
+
+	/* Index of the next unused draw of every stream */
+	for (int i=0; i<N_noise; ++i) {
+		const uint64_t position = Rands[i].position - (noise_block - noise_pos);
+		ar(position);
+	}
+	snapshot_fields(ar, *this);
+	if (!out) {
+		throw std::runtime_error("writing the snapshot failed");
+	}
+}
 
-		/* Get the random number for the first iteration */
-		Rand_vars.push_back(MTRands[2*i]());
-		Rand_vars.push_back(MTRands[2*i+1]());
+void CA3_Column::load(std::istream& in) {
+	Snapshot_Reader ar{in};
+	uint64_t seed;
+	uint32_t realization;
+	read_snapshot_header(ar, RNG_CA3, seed, realization, N_noise);
+
+	/* Recreate the streams at the stored positions and regenerate the noise block */
+	set_RNG(seed, realization);
+	for (int i=0; i<N_noise; ++i) {
+		uint64_t position;
+		ar(position);
+		Rands[i].seek(position);
 	}
+	fill_noise();
+	snapshot_fields(ar, *this);
 }
 /****************************************************************************************************/
 /*										 		end			 										*/
@@ -68,6 +183,26 @@ double CA3_Column::noise_xRK(int N, int M) const{
 double CA3_Column::noise_aRK(int M) const{
 	return gamma_p * gamma_p * (Rand_vars[2*M] - Rand_vars[2*M+1]*std::sqrt(3))/4;
 }
+
+/* Generates the noise of the next noise_block steps for every stream */
+void CA3_Column::fill_noise(void) {
+	PROFILE_SCOPE(PROFILE_NOISE);
+	for (int i=0; i<N_noise; ++i) {
+		Rands[i].fill(&Noise[i*noise_block], noise_block);
+	}
+	noise_pos = 0;
+}
+
+/* Draws the noise of the next step of dt */
+void CA3_Column::next_noise(void) {
+	if (noise_pos == noise_block) {
+		fill_noise();
+	}
+	for (int i=0; i<N_noise; ++i) {
+		Rand_vars[i] = Noise[i*noise_block + noise_pos] + input;
+	}
+	++noise_pos;
+}
 /****************************************************************************************************/
 /*										 		end			 										*/
 /****************************************************************************************************/
@@ -78,13 +213,13 @@ double CA3_Column::noise_aRK(int M) const{
 /****************************************************************************************************/
 /* Pyramidal firing rate */
 double CA3_Column::get_Qp	(int N) const{
-	double q = Qp_max / (1 + exp(-C1 * (N_pp * y_pp[N] - N_fp * y_fA[N] - theta_p) / sigma_p));
+	double q = sigmoid(Qp_max, C1 * (N_pp * y_pp[N] - N_fp * y_fA[N] - theta_p) / sigma_p);
 	return q;
 }
 
 /* Inhibitory firing rate */
 double CA3_Column::get_Qf	(int N) const{
-	double q = Qf_max / (1 + exp(-C1 * (N_pf * y_pf[N] - N_ff * y_fA[N]- theta_f) / sigma_f));
+	double q = sigmoid(Qf_max, C1 * (N_pf * y_pf[N] - N_ff * y_fA[N]- theta_f) / sigma_f);
 	return q;
 }
 /****************************************************************************************************/
@@ -146,13 +281,14 @@ double CA3_Column::I_L_f	(int N) const{
 /*										Calculate the Nth SRK term									*/
 /****************************************************************************************************/
 void CA3_Column::get_RK (int N) {
+	PROFILE_SCOPE(PROFILE_RK_CA3);
 	extern const double dt;
 	V_p	[N+1] = V_p [0] + A[N]*dt*(-(I_L_p(N) + I_pp(N) + I_fp(N) )/tau_p);
 	V_f	[N+1] = V_f [0] + A[N]*dt*(-(I_L_f(N) + I_pf(N) + I_ff(N) )/tau_f);
 	y_pp[N+1] = y_pp[0] + A[N]*dt*(x_pp[N]);
 	y_pf[N+1] = y_pf[0] + A[N]*dt*(x_pf[N]);
 	y_fA[N+1] = y_fA[0] + A[N]*dt*(x_fA[N]);
-	x_pp[N+1] = x_pp[0] + A[N]*dt*gamma_p *(G_p * (get_Qp(N) - y_pp[N]) - 2 * x_pp[N]) + noise_xRK(N, 0);
+	x_pp[N+1] = x_pp[0] + A[N]*dt*gamma_p *(G_p * (get_Qp(N) + afferent - y_pp[N]) - 2 * x_pp[N]) + noise_xRK(N, 0);
 	x_pf[N+1] = x_pf[0] + A[N]*dt*gamma_p *(G_p * (get_Qp(N) - y_pf[N]) - 2 * x_pf[N]) + noise_xRK(N, 1);
 	x_fA[N+1] = x_fA[0] + A[N]*dt*gamma_fA*(G_fA* (get_Qf(N) - y_fA[N]) - 2 * x_fA[N]);
 }
@@ -165,6 +301,7 @@ void CA3_Column::get_RK (int N) {
 /*									Function that adds all SRK terms								*/
 /****************************************************************************************************/
 void CA3_Column::add_RK(void) {
+	PROFILE_SCOPE(PROFILE_ADD_RK);
 	V_p	[0] = (-3*V_p [0] + 2*V_p [1] + 4*V_p [2] + 2*V_p [3] + V_p	[4])/6;
 	V_f	[0] = (-3*V_f [0] + 2*V_f [1] + 4*V_f [2] + 2*V_f [3] + V_f	[4])/6;
 	y_pp[0] = (-3*y_pp[0] + 2*y_pp[1] + 4*y_pp[2] + 2*y_pp[3] + y_pp[4])/6;
@@ -175,9 +312,212 @@ void CA3_Column::add_RK(void) {
 	x_fA[0] = (-3*x_fA[0] + 2*x_fA[1] + 4*x_fA[2] + 2*x_fA[3] + x_fA[4])/6;
 
 	/* Generate noise for the next iteration */
-	for (unsigned i=0; i<Rand_vars.size(); ++i) {
-		Rand_vars[i] = MTRands[i]() + input;
+	next_noise();
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Fused SRK4 step												*/
+/****************************************************************************************************/
+/* As Cortical_Column::step, the variables are ordered V_p, V_f, y_pp, y_pf, y_fA and x_pp, x_pf,	*/
+/* x_fA																								*/
+void CA3_Column::step(void) {
+	PROFILE_SCOPE(PROFILE_RK_CA3);
+	extern const double dt;
+	array<double, 5>* const Y[5] = {&V_p, &V_f, &y_pp, &y_pf, &y_fA};
+	array<double, 5>* const X[3] = {&x_pp, &x_pf, &x_fA};
+	const double G[3]		= {G_p, G_p, G_fA};
+	const double gamma[3]	= {gamma_p, gamma_p, gamma_fA};
+
+	/* Noise of the pyramidal PSPs, see noise_xRK and noise_aRK */
+	const double g2	= gamma_p * gamma_p;
+	const double s3	= std::sqrt(3);
+	double xi[2], eta[2];
+	for (int M=0; M<2; ++M) {
+		xi[M]	= g2 * (Rand_vars[2*M] + Rand_vars[2*M+1]/s3);
+		eta[M]	= g2 * (Rand_vars[2*M] - Rand_vars[2*M+1]*s3)/4;
+	}
+
+	/* Initial values, values of the current stage and sums of the moments */
+	double y0[5], x0[3], y[5], x[3], sy[5], sx[3];
+	for (int i=0; i<5; ++i) {
+		y0[i] = y[i] = (*Y[i])[0];
+		sy[i] = -3*y0[i];
+	}
+	for (int i=0; i<3; ++i) {
+		x0[i] = x[i] = (*X[i])[0];
+		sx[i] = -3*x0[i];
+	}
+
+	/* Weights of the moments in add_RK */
+	static constexpr double C[4] = {2, 4, 2, 1};
+	for (int N=0; N<4; ++N) {
+		const double h	= A[N]*dt;
+		const double Vp = y[0], Vf = y[1], ypp = y[2], ypf = y[3], yfA = y[4];
+
+		/* Firing rates, see get_Qp and get_Qf */
+		const double Qp = sigmoid(Qp_max, C1 * (N_pp * ypp - N_fp * yfA - theta_p) / sigma_p);
+		const double Qf = sigmoid(Qf_max, C1 * (N_pf * ypf - N_ff * yfA - theta_f) / sigma_f);
+		const double Q[3] = {Qp + afferent, Qp, Qf};
+
+		/* Leak and synaptic currents, see I_L_p, I_pp, ... */
+		const double I_p = g_L * (Vp - E_L) + ypp * (Vp - E_AMPA) + yfA * N_fp * (Vp - E_GABA);
+		const double I_f = g_L * (Vf - E_L) + ypf * (Vf - E_AMPA) + yfA * N_ff * (Vf - E_GABA);
+
+		double y1[5], x1[3];
+		y1[0] = y0[0] + h*(-I_p/tau_p);
+		y1[1] = y0[1] + h*(-I_f/tau_f);
+		for (int i=0; i<3; ++i) {
+			y1[i+2] = y0[i+2] + h*(x[i]);
+			x1[i]	= x0[i] + h*gamma[i]*(G[i] * (Q[i] - y[i+2]) - 2 * x[i]);
+		}
+		for (int M=0; M<2; ++M) {
+			x1[M] += xi[M]*B[N];
+		}
+		for (int i=0; i<5; ++i) {
+			y[i]	 = y1[i];
+			sy[i]	+= C[N]*y1[i];
+		}
+		for (int i=0; i<3; ++i) {
+			x[i]	 = x1[i];
+			sx[i]	+= C[N]*x1[i];
+		}
+	}
+
+	for (int i=0; i<5; ++i) {
+		(*Y[i])[0] = sy[i]/6;
+	}
+	for (int i=0; i<3; ++i) {
+		(*X[i])[0] = sx[i]/6;
+	}
+	for (int M=0; M<2; ++M) {
+		(*X[M])[0] += eta[M];
 	}
+
+	/* Generate noise for the next iteration */
+	next_noise();
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Exponential integrator										*/
+/****************************************************************************************************/
+/* Coefficients of the polynomial p[0] + p[1] s + p[2] s^2 through the values f[0], f[1] and f[2]	*/
+/* at the relative times 0, c and 1 of a step, linear for c = 1								*/
+static void quadratic(const double* f, double c, double* p) {
+	p[0] = f[0];
+	p[2] = c < 1.0 ? ((f[1] - f[0]) / c - (f[2] - f[0])) / (c - 1) : 0.0;
+	p[1] = f[2] - f[0] - p[2];
+}
+
+/* Membrane after a step of H, V' = -a(t) V + b(t) with the coefficients a and b at the nodes of	*/
+/* the step, s = t/H:																				*/
+/*		V(H) = exp(-A(H)) V(0) + H int_0^1 exp(A(s) - A(H)) b(s) ds,	A(s) = int_0^s a			*/
+/* At rest the membrane relaxes within a fraction of dt, so the decay exp(-lambda (1-s)) with		*/
+/* lambda = A(H) is integrated exactly. The rest g(s) = exp(A(s) - A(H) + lambda (1-s)) b(s) is		*/
+/* smooth and interpolated through the nodes like a and b											*/
+static double relax(double V, const double* a, const double* b, double c, double H) {
+	double p[3], q[3];
+	quadratic(a, c, p);
+	auto A = [&](double s) {return H * s * (p[0] + s * (p[1]/2 + s * p[2]/3));};
+	const double lambda = A(1.0);
+	const double g[3]	= {b[0], std::exp(A(c) - lambda * c) * b[1], b[2]};
+	quadratic(g, c, q);
+
+	/* I_n = int_0^1 exp(-lambda (1-s)) s^n ds by the recurrence I_n = (1 - n I_n-1) / lambda. The	*/
+	/* noise drives the conductances below zero at times, so lambda may vanish or turn negative.	*/
+	/* There the recurrence cancels and the series I_n = sum_m (-lambda)^m n!/(n+m+1)! is used		*/
+	const double decay = std::exp(-lambda);
+	double I[3];
+	if (std::fabs(lambda) < 1.0) {
+		for (int n=0; n<3; ++n) {
+			double term = 1.0 / (n + 1);
+			I[n] = term;
+			for (int m=1; m<20; ++m) {
+				term *= -lambda / (n + m + 1);
+				I[n] += term;
+			}
+		}
+	} else {
+		I[0] = (1 - decay) / lambda;
+		I[1] = (1 - I[0]) / lambda;
+		I[2] = (1 - 2 * I[1]) / lambda;
+	}
+	return decay * V + H * (q[0] * I[0] + q[1] * I[1] + q[2] * I[2]);
+}
+
+void CA3_Column::set_exponential(int k) {
+	if (k > PSP_Propagator::max_fixed_substeps) {
+		throw std::invalid_argument("CA3_Column: exponential step longer than max_fixed_substeps");
+	}
+	set_propagators(Exp, k);
+}
+
+void CA3_Column::set_propagators(Propagators& P, int k) const {
+	P[0].set(gamma_p,  G_p,  k);
+	P[1].set(gamma_p,  G_p,  k);
+	P[2].set(gamma_fA, G_fA, k);
+}
+
+void CA3_Column::exp_step(const Propagators& P) {
+	PROFILE_SCOPE(PROFILE_RK_CA3);
+	extern const double dt;
+	const double g2 = gamma_p * gamma_p;
+	const double H	= P[0].substeps() * dt;
+
+	/* Noise of the k steps of dt, with the increments of SRK4 */
+	double noise[2][4] = {};
+	for (int j=0; j<P[0].substeps(); ++j) {
+		for (int M=0; M<2; ++M) {
+			P[M].add_noise(j, g2 * (Rand_vars[2*M] + Rand_vars[2*M+1]/std::sqrt(3)), noise_aRK(M), noise[M]);
+		}
+		next_noise();
+	}
+	const double zero[4] = {0.0, 0.0, 0.0, 0.0};
+
+	/* The membranes relax linearly, V' = -a V + b, with coefficients set by the PSPs at the start,	*/
+	/* the interior node and the end of the step												*/
+	double a_p[3], b_p[3], a_f[3], b_f[3];
+	auto coefficients = [this](int n, int N, const array<double, 5>& y_e, double N_i, double tau, double* a, double* b) {
+		a[n] = (g_L + y_e[N] + N_i * y_fA[N]) / tau;
+		b[n] = (g_L * E_L + y_e[N] * E_AMPA + N_i * y_fA[N] * E_GABA) / tau;
+	};
+	coefficients(0, 0, y_pp, N_fp, tau_p, a_p, b_p);
+	coefficients(0, 0, y_pf, N_ff, tau_f, a_f, b_f);
+
+	/* Predictor */
+	const double Qp0 = get_Qp(0), Qf0 = get_Qf(0);
+	P[0].predict(y_pp.data(), x_pp.data(), Qp0 + afferent, noise[0]);
+	P[1].predict(y_pf.data(), x_pf.data(), Qp0, noise[1]);
+	P[2].predict(y_fA.data(), x_fA.data(), Qf0, zero);
+
+	/* Collocation with the rates at the interior node and the end of the step */
+	for (int i=0; i<PSP_Propagator::iterations; ++i) {
+		const double Qpc = get_Qp(3), Qfc = get_Qf(3), Qp1 = get_Qp(2), Qf1 = get_Qf(2);
+		P[0].collocate(y_pp.data(), x_pp.data(), Qp0 + afferent, Qpc + afferent, Qp1 + afferent, noise[0]);
+		P[1].collocate(y_pf.data(), x_pf.data(), Qp0, Qpc, Qp1, noise[1]);
+		P[2].collocate(y_fA.data(), x_fA.data(), Qf0, Qfc, Qf1, zero);
+	}
+	P[0].accept(y_pp.data(), x_pp.data());
+	P[1].accept(y_pf.data(), x_pf.data());
+	P[2].accept(y_fA.data(), x_fA.data());
+
+	/* Relaxation with the coefficients interpolated over the step, the relaxation with the		*/
+	/* initial coefficients is kept as predictor												*/
+	V_p[1] = b_p[0] / a_p[0] + (V_p[0] - b_p[0] / a_p[0]) * std::exp(-a_p[0] * H);
+	V_f[1] = b_f[0] / a_f[0] + (V_f[0] - b_f[0] / a_f[0]) * std::exp(-a_f[0] * H);
+	coefficients(1, 3, y_pp, N_fp, tau_p, a_p, b_p);
+	coefficients(1, 3, y_pf, N_ff, tau_f, a_f, b_f);
+	coefficients(2, 0, y_pp, N_fp, tau_p, a_p, b_p);
+	coefficients(2, 0, y_pf, N_ff, tau_f, a_f, b_f);
+	V_p[0] = relax(V_p[0], a_p, b_p, P[0].interior(), H);
+	V_f[0] = relax(V_f[0], a_f, b_f, P[0].interior(), H);
 }
 /****************************************************************************************************/
 /*										 		end			 										*/
@@ -31,13 +31,18 @@
 /*									Header file of a CA3 module									*/
 /************************************************************************************************/
 #pragma once
+#include <array>
 #include <cmath>
-#include <vector>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "PSP_Propagator.h"
 #include "Random_Stream.h"
-using std::vector;
+#include "Sigmoid.h"
+using std::array;
 
 /****************************************************************************************************/
-/*									Macro for vector initialization									*/
+/*									Macro for state initialization									*/
 /****************************************************************************************************/
 #ifndef _INIT
 #define _INIT(x)	{x, 0.0, 0.0, 0.0, 0.0}
@@ -55,13 +60,31 @@ public:
 	/* Constructors */
 	CA3_Column(void)
 	{set_RNG();}
+	CA3_Column(uint64_t seed, uint32_t realization = 0)
+	{set_RNG(seed, realization);}
 
-	/* Initialize the RNGs */
+	/* Initialize the RNGs, either from rand() or reproducibly from (seed, realization) */
 	void 	set_RNG		(void);
+	void 	set_RNG		(uint64_t seed, uint32_t realization);
 
 	/* Set strength of input */
 	void	set_input	(double I) {input = I;}
 
+	/* Firing rate of afferent pyramidal cells from other columns in ms^-1, enters the pyramidal	*/
+	/* excitatory PSP of the next RK stage, set by the network before every stage				*/
+	void	set_afferent(double phi) {afferent = phi;}
+
+	/* Binary snapshot of the complete state, load throws std::runtime_error on invalid data.	*/
+	/* After load the column continues bit-identically to the saved one. To fork realizations	*/
+	/* from a common state, call set_RNG(seed, realization) after load							*/
+	void	save		(std::ostream& out) const;
+	void	load		(std::istream& in);
+
+	/* Set a model parameter by name, returns false if the name is unknown. Every parameter		*/
+	/* below but C1 is set by its member name. A new dphi restarts the noise streams, so it		*/
+	/* should be set before the run. Only input and the connectivities are part of a snapshot	*/
+	bool	set_param	(const std::string& name, double value);
+
 	/* Firing rates */
 	double 	get_Qp		(int) const;
 	double 	get_Qf		(int) const;
@@ -77,77 +100,128 @@ public:
 	/* Noise function */
 	double 	noise_xRK 	(int, int) const;
 	double 	noise_aRK 	(int) const;
+	void	fill_noise	(void);
 
 	/* ODE functions */
 	void 	get_RK		(int);
 	void 	add_RK		(void);
 
+	/* Fused SRK4 step, bit identical to get_RK(0), ..., get_RK(3) and add_RK for a constant	*/
+	/* afferent rate, see Cortical_Column::step													*/
+	void	step		(void);
+
+	/* Exponential integrator, the linear PSP dynamics are propagated exactly over steps of k*dt	*/
+	/* and only the firing rates are integrated numerically, see PSP_Propagator.h. set_exponential	*/
+	/* throws std::invalid_argument if k is not in [1, PSP_Propagator::max_fixed_substeps], longer	*/
+	/* fixed steps bias the bursts of CA3. Steps with external propagators from set_propagators	*/
+	/* may change k from step to step up to PSP_Propagator::max_substeps						*/
+	typedef array<PSP_Propagator, 3> Propagators;
+	void	set_exponential	(int k);
+	void	set_propagators	(Propagators& P, int k) const;
+	void	exp_step		(void) {exp_step(Exp);}
+	void	exp_step		(const Propagators& P);
+
 	/* Data storage  access */
 	void	get_data (int N, double* V, double * Y) {V[N] = V_p[0]; Y[N] = N_pp*y_pp[0] - N_fp*y_fA[0];}
+	/* Time derivative of the output, slopes for the dense output of exp_step */
+	void	get_slope(double* V, double* Y) const {
+		V[0] = -(I_L_p(0) + I_pp(0) + I_fp(0)) / tau_p;
+		Y[0] = N_pp * x_pp[0] - N_fp * x_fA[0];
+	}
+	/* Embedded error estimate of the output of the last exp_step, corrector minus predictor */
+	void	get_error(double* V, double* Y) const {
+		V[0] = V_p[0] - V_p[1];
+		Y[0] = N_pp * (y_pp[0] - y_pp[1]) - N_fp * (y_fA[0] - y_fA[1]);
+	}
 
 private:
+	/* Fields of a snapshot besides the noise streams */
+	template <typename Archive, typename Column>
+	static void	snapshot_fields	(Archive& ar, Column& c);
+
+	/* Draws the noise of the next step of dt */
+	void	next_noise		(void);
+
+	/* Updates the state that depends on a parameter */
+	void	refresh_param	(const std::string& name);
+
+	/* Number of noise streams, I_{l} and I_{l,0} for every noisy PSP */
+	static const int N_noise = 4;
+
 	/* Random number generators */
-	vector<random_stream_normal> MTRands;
+	array<random_stream_philox, N_noise> Rands;
 
 	/* Container for noise */
-	vector<double>	Rand_vars;
+	array<double, N_noise> Rand_vars;
+
+	/* Block of pre-generated noise, stream i holds the draws of the next steps at	*/
+	/* [i*noise_block, (i+1)*noise_block), noise_pos is the next step to be used	*/
+	static const int noise_block = 64;
+	array<double, N_noise*noise_block> Noise;
+	int				noise_pos	 = 0;
+
+	/* Exact propagators of y_pp, y_pf and y_fA */
+	Propagators		Exp;
 
 	/* Declaration and Initialization of parameters */
 	/* Membrane time in ms */
-	const double 	tau_p 		= 1.;
-	const double 	tau_f 		= 1.;
+	double			tau_p 		= 1.;
+	double			tau_f 		= 1.;
 
 	/* Maximum firing rate in ms^-1 */
-	const double 	Qp_max		= 30.E-3;
-	const double 	Qf_max		= 60.E-3;
+	double			Qp_max		= 30.E-3;
+	double			Qf_max		= 60.E-3;
 
 	/* Sigmoid threshold in mV */
-	const double 	theta_p		= -58.5;
-	const double 	theta_f		= -58.5;
+	double			theta_p		= -58.5;
+	double			theta_f		= -58.5;
 
 	/* Sigmoid gain in mV */
-	const double 	sigma_p		= 4;
-	const double 	sigma_f		= 6;
+	double			sigma_p		= 4;
+	double			sigma_f		= 6;
 
 	/* Scaling parameter for sigmoidal mapping (dimensionless) */
-	const double 	C1          = (3.14159265/sqrt(3));
+	double			C1          = (3.14159265/sqrt(3));
 
 	/* PSP rise time in ms^-1 */
-	const double 	gamma_p		= 180E-3;
-	const double 	gamma_fA	= 220E-3;
+	double			gamma_p		= 180E-3;
+	double			gamma_fA	= 220E-3;
 
 	/* PSP amplitude in mV */
-	const double 	G_p         = 18;
-	const double 	G_fA        = 30;
+	double			G_p         = 18;
+	double			G_fA        = 30;
 
 	/* Conductivities */
 	/* Leak */
-	const double 	g_L    		= 1.;
+	double			g_L    		= 1.;
 
 	/* Reversal potentials in mV */
 	/* synaptic */
-	const double 	E_AMPA  	= 0;
-	const double 	E_GABA  	= -70;
+	double			E_AMPA  	= 0;
+	double			E_GABA  	= -70;
 
 	/* Leak */
-	const double 	E_L 		= -60;
+	double			E_L 		= -60;
 
 	/* Noise parameters in ms^-1 */
-	const double	dphi		= 5E-3;
+	double			dphi		= 5E-3;
 	double			input		= 0.0;
 
-	/* Connectivities (dimensionless) */
-	const double 	N_pp		= 280;
-	const double 	N_pf		= 600;
-	const double 	N_fp		= 280;
-	const double 	N_ff		= 400;
+	/* Afferent firing rate of the current RK stage */
+	double			afferent	= 0.0;
+
+	/* Connectivities (dimensionless), variable for parameter sweeps */
+	double 			N_pp		= 280;
+	double 			N_pf		= 600;
+	double 			N_fp		= 280;
+	double 			N_ff		= 400;
 
 	/* Parameters for SRK4 iteration */
-	const vector<double> A = {0.5,  0.5,  1.0, 1.0};
-	const vector<double> B = {0.75, 0.75, 0.0, 0.0};
+	static constexpr double A[4] = {0.5,  0.5,  1.0, 1.0};
+	static constexpr double B[4] = {0.75, 0.75, 0.0, 0.0};
 
 	/* Population variables */
-	vector<double> 	V_p		= _INIT(E_L),		/* pyramidal membrane voltage       */
+	array<double, 5> V_p		= _INIT(E_L),		/* pyramidal membrane voltage       */
 					V_f     = _INIT(E_L),		/* fast inhibitory membrane voltage */
 					y_pp	= _INIT(0.0),		/* PostSP p to p                    */
 					y_pf	= _INIT(0.0),		/* PostSP p to f                    */
@@ -0,0 +1,320 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Functions of the CA3 ensemble									*/
+/****************************************************************************************************/
+#include <utility>
+#include "CA3_Ensemble.h"
+#include "Profiler.h"
+#include "SRK_Moments.h"
+
+/* Parameters for SRK4 iteration */
+template <typename T, typename S> constexpr double CA3_Ensemble_T<T, S>::A[4];
+template <typename T, typename S> constexpr double CA3_Ensemble_T<T, S>::B[4];
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+template <typename T, typename S>
+CA3_Ensemble_T<T, S>::CA3_Ensemble_T(int R)
+: CA3_Ensemble_T(R, rand())
+{}
+
+template <typename T, typename S>
+CA3_Ensemble_T<T, S>::CA3_Ensemble_T(int R, uint64_t seed)
+: R		(R),
+  Qp	(R), Qf	  (R),
+  V_p	(5*R), V_f  (5*R), y_pp (5*R), y_pf (5*R), y_fA (5*R),
+  x_pp	(5*R), x_pf (5*R), x_fA (5*R)
+{
+	/* Resting state of the membrane voltages, also in the accumulated state of the mixed precision */
+	State.resize(mixed ? N_VARS*R : 0);
+	for (int r=0; r<R; ++r) {
+		V_p[r] = E_L;
+		V_f[r] = E_L;
+		if (mixed) {
+			State[V_P*R + r] = E_L;
+			State[V_F*R + r] = E_L;
+		}
+	}
+	set_RNG(seed);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Parameter access 											*/
+/****************************************************************************************************/
+/* C1 stays constant, as it is no parameter of the column either */
+template <typename T, typename S>
+bool CA3_Ensemble_T<T, S>::set_param(const std::string& name, double value) {
+	typedef CA3_Ensemble_T<T, S> H;
+	static const std::pair<const char*, T H::*> params[] = {
+		{"tau_p",	&H::tau_p},		{"tau_f",	&H::tau_f},		{"Qp_max",	&H::Qp_max},
+		{"Qf_max",	&H::Qf_max},	{"theta_p",	&H::theta_p},	{"theta_f",	&H::theta_f},
+		{"sigma_p",	&H::sigma_p},	{"sigma_f",	&H::sigma_f},	{"gamma_p",	&H::gamma_p},
+		{"gamma_fA",&H::gamma_fA},	{"G_p",		&H::G_p},		{"G_fA",	&H::G_fA},
+		{"g_L",		&H::g_L},		{"E_AMPA",	&H::E_AMPA},	{"E_GABA",	&H::E_GABA},
+		{"E_L",		&H::E_L},		{"N_pp",	&H::N_pp},		{"N_pf",	&H::N_pf},
+		{"N_fp",	&H::N_fp},		{"N_ff",	&H::N_ff}};
+	for (const auto& p : params) {
+		if (name == p.first) {
+			this->*p.second = value;
+			return true;
+		}
+	}
+
+	/* The noise parameters stay in double, a new dphi restarts the streams as in the column */
+	if (name == "input") {
+		input = value;
+		return true;
+	}
+	if (name == "dphi") {
+		dphi = value;
+		set_RNG(seed);
+		return true;
+	}
+	return false;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Initialization of RNG 										*/
+/****************************************************************************************************/
+template <typename T, typename S>
+void CA3_Ensemble_T<T, S>::set_RNG(uint64_t seed) {
+	/* Number of independent random variables */
+	int N = 2;
+
+	/* Every realization uses the streams (seed, r, column, s), all at the same position */
+	this->seed	= seed;
+	position	= 0;
+	Rand_vars.resize(2*N*R);
+	Normals.resize(R);
+	Spare.resize(2*N*R);
+
+	/* Get the random number for the first iteration */
+	draw_noise(0.0);
+}
+
+/* The streams of all realizations are generated as one block per stream and position */
+template <typename T, typename S>
+void CA3_Ensemble_T<T, S>::draw_noise(double shift) {
+	PROFILE_SCOPE(PROFILE_NOISE);
+	extern const double dt;
+	const int M = Rand_vars.size()/R;
+	for (int s=0; s<M; ++s) {
+		T* __restrict__ z			= &Rand_vars[s*R];
+		double* __restrict__ g		= &Normals[0];
+		double* __restrict__ spare	= &Spare[s*R];
+		if (position & 1) {
+			g = spare;
+		} else {
+			random_stream_philox::normal_pairs(position >> 1, seed, RNG_CA3, s, R, g, spare);
+		}
+
+		/* Even streams are I_{l}, odd streams I_{l,0} */
+		const double stddev = s%2 ? dt : dphi*dt;
+		for (int r=0; r<R; ++r) {
+			z[r] = T(0.0 + stddev * g[r] + shift);
+		}
+	}
+	++position;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Firing Rate functions 										*/
+/****************************************************************************************************/
+template <typename T, typename S>
+void CA3_Ensemble_T<T, S>::set_Q (int N) {
+	const T* __restrict__ ypp = stage(y_pp, N);
+	const T* __restrict__ ypf = stage(y_pf, N);
+	const T* __restrict__ yfA = stage(y_fA, N);
+	T* __restrict__ qp = &Qp[0];
+	T* __restrict__ qf = &Qf[0];
+
+	/* Arguments of the sigmoids */
+	for (int r=0; r<R; ++r) {
+		/* Pyramidal firing rate */
+		qp[r] = C1 * (N_pp * ypp[r] - N_fp * yfA[r] - theta_p) / sigma_p;
+		/* Inhibitory firing rate */
+		qf[r] = C1 * (N_pf * ypf[r] - N_ff * yfA[r]- theta_f) / sigma_f;
+	}
+
+	sigmoid(Qp_max, qp, qp, R);
+	sigmoid(Qf_max, qf, qf, R);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Calculate the Nth SRK term									*/
+/****************************************************************************************************/
+template <typename T, typename S>
+void CA3_Ensemble_T<T, S>::get_RK (int N) {
+	PROFILE_SCOPE(PROFILE_ENSEMBLE);
+	extern const double dt;
+	set_Q(N);
+
+	/* Step sizes and noise scaling of the Nth moment */
+	const T h	= A[N]*dt;
+	const T hp	= h*gamma_p;
+	const T hf	= h*gamma_fA;
+	const T g2	= gamma_p * gamma_p;
+	const T s3	= std::sqrt(T(3));
+	const T b	= B[N];
+
+	const T* __restrict__ qp = &Qp[0];
+	const T* __restrict__ qf = &Qf[0];
+
+	/* Noise of the pyramidal streams */
+	const T* __restrict__ n0 = &Rand_vars[0*R];
+	const T* __restrict__ n1 = &Rand_vars[1*R];
+	const T* __restrict__ n2 = &Rand_vars[2*R];
+	const T* __restrict__ n3 = &Rand_vars[3*R];
+
+	/* Initial values */
+	const T* __restrict__ Vp0	= stage(V_p,  0);
+	const T* __restrict__ Vf0	= stage(V_f,  0);
+	const T* __restrict__ ypp0 = stage(y_pp, 0);
+	const T* __restrict__ ypf0 = stage(y_pf, 0);
+	const T* __restrict__ yfA0 = stage(y_fA, 0);
+	const T* __restrict__ xpp0 = stage(x_pp, 0);
+	const T* __restrict__ xpf0 = stage(x_pf, 0);
+	const T* __restrict__ xfA0 = stage(x_fA, 0);
+
+	/* Values of the Nth moment */
+	const T* __restrict__ Vp	= stage(V_p,  N);
+	const T* __restrict__ Vf	= stage(V_f,  N);
+	const T* __restrict__ ypp	= stage(y_pp, N);
+	const T* __restrict__ ypf	= stage(y_pf, N);
+	const T* __restrict__ yfA	= stage(y_fA, N);
+	const T* __restrict__ xpp	= stage(x_pp, N);
+	const T* __restrict__ xpf	= stage(x_pf, N);
+	const T* __restrict__ xfA	= stage(x_fA, N);
+
+	/* Values of the (N+1)th moment */
+	T* __restrict__ Vp1  = stage(V_p,  N+1);
+	T* __restrict__ Vf1  = stage(V_f,  N+1);
+	T* __restrict__ ypp1 = stage(y_pp, N+1);
+	T* __restrict__ ypf1 = stage(y_pf, N+1);
+	T* __restrict__ yfA1 = stage(y_fA, N+1);
+	T* __restrict__ xpp1 = stage(x_pp, N+1);
+	T* __restrict__ xpf1 = stage(x_pf, N+1);
+	T* __restrict__ xfA1 = stage(x_fA, N+1);
+
+	/* Local copies of the parameters, otherwise they are reloaded in every iteration as the stores	*/
+	/* might alias the members. GCC ignores __restrict__ on local pointers, ivdep states that the	*/
+	/* moments do not overlap, which is needed for vectorization									*/
+	const T g_L = this->g_L, E_L = this->E_L, E_AMPA = this->E_AMPA, E_GABA = this->E_GABA;
+	const T N_fp = this->N_fp, N_ff = this->N_ff, tau_p = this->tau_p, tau_f = this->tau_f;
+	const T G_p = this->G_p, G_fA = this->G_fA;
+
+	#pragma GCC ivdep
+	for (int r=0; r<R; ++r) {
+		/* Leak and synaptic currents, see CA3_Column */
+		const T I_L_p	= g_L * (Vp[r] - E_L);
+		const T I_L_f	= g_L * (Vf[r] - E_L);
+		const T I_pp	= ypp[r] * (Vp[r] - E_AMPA);
+		const T I_pf	= ypf[r] * (Vf[r] - E_AMPA);
+		const T I_fp	= yfA[r] * N_fp * (Vp[r] - E_GABA);
+		const T I_ff	= yfA[r] * N_ff * (Vf[r] - E_GABA);
+
+		Vp1 [r] = Vp0 [r] + h*(-(I_L_p + I_pp + I_fp )/tau_p);
+		Vf1 [r] = Vf0 [r] + h*(-(I_L_f + I_pf + I_ff )/tau_f);
+		ypp1[r] = ypp0[r] + h*(xpp[r]);
+		ypf1[r] = ypf0[r] + h*(xpf[r]);
+		yfA1[r] = yfA0[r] + h*(xfA[r]);
+		xpp1[r] = xpp0[r] + hp*(G_p * (qp[r] - ypp[r]) - 2 * xpp[r]) + g2 * (n0[r] + n1[r]/s3)*b;
+		xpf1[r] = xpf0[r] + hp*(G_p * (qp[r] - ypf[r]) - 2 * xpf[r]) + g2 * (n2[r] + n3[r]/s3)*b;
+		xfA1[r] = xfA0[r] + hf*(G_fA* (qf[r] - yfA[r]) - 2 * xfA[r]);
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Function that adds all SRK terms								*/
+/****************************************************************************************************/
+template <typename T, typename S>
+void CA3_Ensemble_T<T, S>::add_RK(void) {
+	PROFILE_SCOPE(PROFILE_ENSEMBLE);
+	const T g2	= gamma_p * gamma_p;
+	if (mixed) {
+		S* acc = &State[0];
+		add_moments(&V_p [0], acc + V_P *R, R);
+		add_moments(&V_f [0], acc + V_F *R, R);
+		add_moments(&y_pp[0], acc + Y_PP*R, R);
+		add_moments(&y_pf[0], acc + Y_PF*R, R);
+		add_moments(&y_fA[0], acc + Y_FA*R, R);
+		add_moments(&x_pp[0], acc + X_PP*R, &Rand_vars[0*R], &Rand_vars[1*R], g2, R);
+		add_moments(&x_pf[0], acc + X_PF*R, &Rand_vars[2*R], &Rand_vars[3*R], g2, R);
+		add_moments(&x_fA[0], acc + X_FA*R, R);
+	} else {
+		add_moments(&V_p [0], R);
+		add_moments(&V_f [0], R);
+		add_moments(&y_pp[0], R);
+		add_moments(&y_pf[0], R);
+		add_moments(&y_fA[0], R);
+		add_moments(&x_pp[0], &Rand_vars[0*R], &Rand_vars[1*R], g2, R);
+		add_moments(&x_pf[0], &Rand_vars[2*R], &Rand_vars[3*R], g2, R);
+		add_moments(&x_fA[0], R);
+	}
+
+	/* Generate noise for the next iteration */
+	draw_noise(input);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Instantiation of the precisions									*/
+/****************************************************************************************************/
+template class CA3_Ensemble_T<double>;
+template class CA3_Ensemble_T<float>;
+template class CA3_Ensemble_T<float, double>;
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,182 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/************************************************************************************************/
+/*								Header file of an ensemble of CA3 modules						*/
+/*																								*/
+/*		Holds R independent noisy realizations of CA3_Column in structure-of-arrays form.		*/
+/*		The memory layout and the precision modes are identical to Cortical_Ensemble.			*/
+/************************************************************************************************/
+#pragma once
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Random_Stream.h"
+#include "Sigmoid.h"
+using std::vector;
+
+
+/****************************************************************************************************/
+/*									Implementation of the CA3 ensemble 								*/
+/****************************************************************************************************/
+template <typename T, typename S = T>
+class CA3_Ensemble_T {
+public:
+	/* Constructors, realization r is keyed by (seed, r) and matches the column seeded alike */
+	CA3_Ensemble_T(int R);
+	CA3_Ensemble_T(int R, uint64_t seed);
+
+	/* Initialize the RNGs */
+	void 	set_RNG		(uint64_t seed);
+
+	/* Set strength of input */
+	void	set_input	(double I) {input = I;}
+
+	/* Set a model parameter of all realizations by name, with the names of					*/
+	/* CA3_Column::set_param. Returns false if the name is unknown								*/
+	bool	set_param	(const std::string& name, double value);
+
+	/* Number of realizations */
+	int		size		(void) const {return R;}
+
+	/* ODE functions */
+	void 	get_RK		(int);
+	void 	add_RK		(void);
+
+	/* Data storage  access */
+	void	get_data (int N, int r, double* V, double * Y) const
+	{V[N] = value(V_p, V_P, r); Y[N] = N_pp*value(y_pp, Y_PP, r) - N_fp*value(y_fA, Y_FA, r);}
+
+private:
+	/* Firing rates of all realizations at the Nth SRK moment */
+	void 	set_Q		(int);
+
+	/* Pointer to the Nth SRK moment of a state variable */
+	T*	 			stage	(vector<T>& x, int N) 		 {return &x[N*R];}
+	const T*		stage	(const vector<T>& x, int N) const {return &x[N*R];}
+
+	/* Current value of variable k, the accumulated one in mixed precision */
+	S				value	(const vector<T>& x, int k, int r) const
+	{return mixed ? State[k*R+r] : x[r];}
+
+	/* Number of realizations */
+	const int		R;
+
+	/* Draw the noise of all realizations at the current position of the streams */
+	void	draw_noise	(double shift);
+
+	/* Key and common position of the noise streams, 4 per realization */
+	uint64_t		seed;
+	uint64_t		position;
+
+	/* Container for noise, stream s of realization r is stored at [s*R + r] */
+	vector<T>		Rand_vars;
+
+	/* Normals of the current position and second normal of every Box-Muller pair, used by the	*/
+	/* odd positions. Both are generated in double precision regardless of T					*/
+	vector<double>	Normals;
+	vector<double>	Spare;
+
+	/* In mixed precision the SRK moments are stored in T, while the new state is accumulated	*/
+	/* in S. Variable k of realization r is stored at [k*R + r], see add_RK for the order		*/
+	static constexpr bool mixed = !std::is_same<T, S>::value;
+	vector<S>		State;
+
+	/* Firing rates of the current SRK moment */
+	vector<T>		Qp, Qf;
+
+	/* Declaration and Initialization of parameters */
+	/* Membrane time in ms */
+	T 				tau_p 		= 1.;
+	T 				tau_f 		= 1.;
+
+	/* Maximum firing rate in ms^-1 */
+	T 				Qp_max		= 30.E-3;
+	T 				Qf_max		= 60.E-3;
+
+	/* Sigmoid threshold in mV */
+	T 				theta_p		= -58.5;
+	T 				theta_f		= -58.5;
+
+	/* Sigmoid gain in mV */
+	T 				sigma_p		= 4;
+	T 				sigma_f		= 6;
+
+	/* Scaling parameter for sigmoidal mapping (dimensionless) */
+	const T 		C1          = (3.14159265/sqrt(3));
+
+	/* PSP rise time in ms^-1 */
+	T 				gamma_p		= 180E-3;
+	T 				gamma_fA	= 220E-3;
+
+	/* PSP amplitude in mV */
+	T 				G_p         = 18;
+	T 				G_fA        = 30;
+
+	/* Conductivities */
+	/* Leak */
+	T 				g_L    		= 1.;
+
+	/* Reversal potentials in mV */
+	/* synaptic */
+	T 				E_AMPA  	= 0;
+	T 				E_GABA  	= -70;
+
+	/* Leak */
+	T 				E_L 		= -60;
+
+	/* Noise parameters in ms^-1 */
+	double			dphi		= 5E-3;
+	double			input		= 0.0;
+
+	/* Connectivities (dimensionless) */
+	T 				N_pp		= 280;
+	T 				N_pf		= 600;
+	T 				N_fp		= 280;
+	T 				N_ff		= 400;
+
+	/* Parameters for SRK4 iteration */
+	static constexpr double A[4] = {0.5,  0.5,  1.0, 1.0};
+	static constexpr double B[4] = {0.75, 0.75, 0.0, 0.0};
+
+	/* Population variables, see CA3_Column */
+	vector<T> 		V_p, V_f, y_pp, y_pf, y_fA, x_pp, x_pf, x_fA;
+
+	/* Index of the variables in State */
+	enum Variable	{V_P, V_F, Y_PP, Y_PF, Y_FA, X_PP, X_PF, X_FA, N_VARS};
+};
+
+/* Double precision reference, float and mixed precision ensembles */
+typedef CA3_Ensemble_T<double>			CA3_Ensemble;
+typedef CA3_Ensemble_T<float>			CA3_Ensemble_Float;
+typedef CA3_Ensemble_T<float, double>	CA3_Ensemble_Mixed;
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -30,28 +30,153 @@
 /****************************************************************************************************/
 /*									Functions of the cortical module								*/
 /****************************************************************************************************/
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include "Cortical_Column.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+
+/* The state is held by value, so columns can be copied as plain memory */
+static_assert(std::is_trivially_copyable<Cortical_Column>::value, "Cortical_Column must be trivially copyable");
+
+/* Parameters for SRK4 iteration */
+constexpr double Cortical_Column::A[4];
+constexpr double Cortical_Column::B[4];
 
 /****************************************************************************************************/
 /*										 Initialization of RNG 										*/
 /****************************************************************************************************/
 void Cortical_Column::set_RNG(void) {
-	extern const double dt;
-	/* Number of independent random variables */
-	int N = 3;
+	set_RNG(rand(), 0);
+}
 
+/* Reproducible initialization, the streams are keyed by (seed, realization, column, stream) */
+void Cortical_Column::set_RNG(uint64_t seed, uint32_t realization) {
+	extern const double dt;
 	/* Create RNG for each stream */
-	for (int i=0; i<N; ++i){
+	for (int i=0; i<N_noise/2; ++i){
 		/* Add the RNG for I_{l}*/
-		MTRands.push_back(random_stream_normal(0.0, dphi*dt));
+		Rands[2*i]	 = random_stream_philox(0.0, dphi*dt, seed, realization, RNG_CORTEX, 2*i);
 
 		/* Add the RNG for I_{l,0} */
-		MTRands.push_back(random_stream_normal(0.0, dt));
+		Rands[2*i+1] = random_stream_philox(0.0, dt, seed, realization, RNG_CORTEX, 2*i+1);
+	}
+
+	/* Get the random number for the first iteration */
+	fill_noise();
+	for (int i=0; i<N_noise; ++i) {
+		Rand_vars[i] = Noise[i*noise_block];
+	}
+	noise_pos = 1;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Parameter access 											*/
+/****************************************************************************************************/
+bool Cortical_Column::set_param(const std::string& name, double value) {
+	typedef Cortical_Column C;
+	static const std::pair<const char*, double C::*> params[] = {
+		{"tau_p",	&C::tau_p},		{"tau_s",	&C::tau_s},		{"tau_f",	&C::tau_f},
+		{"Qp_max",	&C::Qp_max},	{"Qs_max",	&C::Qs_max},	{"Qf_max",	&C::Qf_max},
+		{"theta_p",	&C::theta_p},	{"theta_s",	&C::theta_s},	{"theta_f",	&C::theta_f},
+		{"sigma_p",	&C::sigma_p},	{"sigma_s",	&C::sigma_s},	{"sigma_f",	&C::sigma_f},
+		{"gamma_p",	&C::gamma_p},	{"gamma_sA",&C::gamma_sA},	{"gamma_fA",&C::gamma_fA},
+		{"gamma_sB",&C::gamma_sB},	{"G_p",		&C::G_p},		{"G_sA",	&C::G_sA},
+		{"G_fA",	&C::G_fA},		{"G_sB",	&C::G_sB},		{"dphi",	&C::dphi},
+		{"input",	&C::input},		{"N_pp",	&C::N_pp},		{"N_ps",	&C::N_ps},
+		{"N_pf",	&C::N_pf},		{"N_sp",	&C::N_sp},		{"N_ss",	&C::N_ss},
+		{"N_sf",	&C::N_sf},		{"N_fp",	&C::N_fp},		{"N_ff",	&C::N_ff}};
+	for (const auto& p : params) {
+		if (name == p.first) {
+			this->*p.second = value;
+			refresh_param(name);
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Updates the state that depends on a parameter */
+void Cortical_Column::refresh_param(const std::string& name) {
+	if (name == "dphi") {
+		set_RNG(Rands[0].seed, Rands[0].realization);
+	}
+	if (Exp[0].substeps() > 0 && (name.compare(0, 6, "gamma_") == 0 || name.compare(0, 2, "G_") == 0)) {
+		set_exponential(Exp[0].substeps());
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
 
-		/* Get the random number for the first iteration */
-		Rand_vars.push_back(MTRands[2*i]());
-		Rand_vars.push_back(MTRands[2*i+1]());
+/****************************************************************************************************/
+/*										 	State snapshots 										*/
+/****************************************************************************************************/
+/* Only the first SRK moment is stored, the others are overwritten before they are used */
+template <typename Archive, typename Column>
+void Cortical_Column::snapshot_fields(Archive& ar, Column& c) {
+	ar(c.y_pp[0]);
+	ar(c.y_ps[0]);
+	ar(c.y_pf[0]);
+	ar(c.y_sA[0]);
+	ar(c.y_sB[0]);
+	ar(c.y_fA[0]);
+	ar(c.x_pp[0]);
+	ar(c.x_ps[0]);
+	ar(c.x_pf[0]);
+	ar(c.x_sA[0]);
+	ar(c.x_sB[0]);
+	ar(c.x_fA[0]);
+	for (int i=0; i<N_noise; ++i) {
+		ar(c.Rand_vars[i]);
 	}
+	ar(c.input);
+	ar(c.N_pp);
+	ar(c.N_ps);
+	ar(c.N_pf);
+	ar(c.N_sp);
+	ar(c.N_ss);
+	ar(c.N_sf);
+	ar(c.N_fp);
+	ar(c.N_ff);
+}
+
+void Cortical_Column::save(std::ostream& out) const {
+	Snapshot_Writer ar{out};
+	write_snapshot_header(ar, RNG_CORTEX, Rands[0].seed, Rands[0].realization, N_noise);
+
+	/* Index of the next unused draw of every stream */
+	for (int i=0; i<N_noise; ++i) {
+		const uint64_t position = Rands[i].position - (noise_block - noise_pos);
+		ar(position);
+	}
+	snapshot_fields(ar, *this);
+	if (!out) {
+		throw std::runtime_error("writing the snapshot failed");
+	}
+}
+
+void Cortical_Column::load(std::istream& in) {
+	Snapshot_Reader ar{in};
+	uint64_t seed;
+	uint32_t realization;
+	read_snapshot_header(ar, RNG_CORTEX, seed, realization, N_noise);
+
+	/* Recreate the streams at the stored positions and regenerate the noise block */
+	set_RNG(seed, realization);
+	for (int i=0; i<N_noise; ++i) {
+		uint64_t position;
+		ar(position);
+		Rands[i].seek(position);
+	}
+	fill_noise();
+	snapshot_fields(ar, *this);
 }
 /****************************************************************************************************/
 /*										 		end			 										*/
@@ -68,6 +193,26 @@ double Cortical_Column::noise_xRK(int N, int M) const{
 double Cortical_Column::noise_aRK(int M) const{
 	return gamma_p * gamma_p * (Rand_vars[2*M] - Rand_vars[2*M+1]*std::sqrt(3))/4;
 }
+
+/* Generates the noise of the next noise_block steps for every stream */
+void Cortical_Column::fill_noise(void) {
+	PROFILE_SCOPE(PROFILE_NOISE);
+	for (int i=0; i<N_noise; ++i) {
+		Rands[i].fill(&Noise[i*noise_block], noise_block);
+	}
+	noise_pos = 0;
+}
+
+/* Draws the noise of the next step of dt */
+void Cortical_Column::next_noise(void) {
+	if (noise_pos == noise_block) {
+		fill_noise();
+	}
+	for (int i=0; i<N_noise; ++i) {
+		Rand_vars[i] = Noise[i*noise_block + noise_pos] + input;
+	}
+	++noise_pos;
+}
 /****************************************************************************************************/
 /*										 		end			 										*/
 /****************************************************************************************************/
@@ -78,19 +223,19 @@ double Cortical_Column::noise_aRK(int M) const{
 /****************************************************************************************************/
 /* Pyramidal firing rate */
 double Cortical_Column::get_Qp	(int N) const{
-	double q = Qp_max / (1 + exp(-(N_pp * y_pp[N] - N_sp * y_sA[N] - N_fp * y_fA[N] - theta_p) / sigma_p));
+	double q = sigmoid(Qp_max, (N_pp * y_pp[N] - N_sp * y_sA[N] - N_fp * y_fA[N] - theta_p) / sigma_p);
 	return q;
 }
 
 /* Slow inhibitory firing rate */
 double Cortical_Column::get_Qs	(int N) const{
-	double q = Qs_max / (1 + exp(-(N_ps * y_ps[N] - N_ss * y_sA[N] - theta_s) / sigma_s));
+	double q = sigmoid(Qs_max, (N_ps * y_ps[N] - N_ss * y_sA[N] - theta_s) / sigma_s);
 	return q;
 }
 
 /* Fast inhibitory firing rate */
 double Cortical_Column::get_Qf	(int N) const{
-	double q = Qf_max / (1 + exp(-(N_pf * y_pf[N] - N_sf * y_sA[N] - N_ff * y_fA[N] - theta_f) / sigma_f));
+	double q = sigmoid(Qf_max, (N_pf * y_pf[N] - N_sf * y_sA[N] - N_ff * y_fA[N] - theta_f) / sigma_f);
 	return q;
 }
 /****************************************************************************************************/
@@ -102,6 +247,7 @@ double Cortical_Column::get_Qf	(int N) const{
 /*										Calculate the Nth SRK term									*/
 /****************************************************************************************************/
 void Cortical_Column::set_RK (int N) {
+	PROFILE_SCOPE(PROFILE_RK_CORTEX);
 	extern const double dt;
 	y_pp	[N+1] = y_pp[0] + A[N]*dt*(x_pp[N]);
 	y_ps	[N+1] = y_ps[0] + A[N]*dt*(x_ps[N]);
@@ -109,7 +255,7 @@ void Cortical_Column::set_RK (int N) {
 	y_sA	[N+1] = y_sA[0] + A[N]*dt*(x_sA[N]);
 	y_sB	[N+1] = y_sB[0] + A[N]*dt*(x_sB[N]);
 	y_fA	[N+1] = y_fA[0] + A[N]*dt*(x_fA[N]);
-	x_pp  	[N+1] = x_pp[0] + A[N]*dt*gamma_p*(G_p * (get_Qp(N) - y_pp[N]) - 2 * x_pp[N]) + noise_xRK(N, 0);
+	x_pp  	[N+1] = x_pp[0] + A[N]*dt*gamma_p*(G_p * (get_Qp(N) + afferent - y_pp[N]) - 2 * x_pp[N]) + noise_xRK(N, 0);
 	x_ps  	[N+1] = x_ps[0] + A[N]*dt*gamma_p*(G_p * (get_Qp(N) - y_ps[N]) - 2 * x_ps[N]) + noise_xRK(N, 1);
 	x_pf  	[N+1] = x_pf[0] + A[N]*dt*gamma_p*(G_p * (get_Qp(N) - y_pf[N]) - 2 * x_pf[N]) + noise_xRK(N, 2);
 	x_sA  	[N+1] = x_sA[0] + A[N]*dt*gamma_p*(G_sA* (get_Qs(N) - y_sA[N]) - 2 * x_sA[N]);
@@ -125,6 +271,7 @@ void Cortical_Column::set_RK (int N) {
 /*									Function that adds all SRK terms								*/
 /****************************************************************************************************/
 void Cortical_Column::add_RK(void) {
+	PROFILE_SCOPE(PROFILE_ADD_RK);
 	y_pp[0] = (-3*y_pp[0] + 2*y_pp[1] + 4*y_pp[2] + 2*y_pp[3] + y_pp[4])/6;
 	y_ps[0] = (-3*y_ps[0] + 2*y_ps[1] + 4*y_ps[2] + 2*y_ps[3] + y_ps[4])/6;
 	y_pf[0] = (-3*y_pf[0] + 2*y_pf[1] + 4*y_pf[2] + 2*y_pf[3] + y_pf[4])/6;
@@ -138,9 +285,145 @@ void Cortical_Column::add_RK(void) {
 	x_sB[0] = (-3*x_sB[0] + 2*x_sB[1] + 4*x_sB[2] + 2*x_sB[3] + x_sB[4])/6;
 	x_fA[0] = (-3*x_fA[0] + 2*x_fA[1] + 4*x_fA[2] + 2*x_fA[3] + x_fA[4])/6;
 	/* Generate noise for the next iteration */
-	for (unsigned i=0; i<Rand_vars.size(); ++i) {
-		Rand_vars[i] = MTRands[i]() + input;
+	next_noise();
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Fused SRK4 step												*/
+/****************************************************************************************************/
+/* The stages are held in local arrays, ordered pp, ps, pf, sA, sB, fA. The sums of add_RK are		*/
+/* accumulated stage by stage in the same order, so the result is bit identical					*/
+void Cortical_Column::step(void) {
+	PROFILE_SCOPE(PROFILE_RK_CORTEX);
+	extern const double dt;
+	array<double, 5>* const Y[6] = {&y_pp, &y_ps, &y_pf, &y_sA, &y_sB, &y_fA};
+	array<double, 5>* const X[6] = {&x_pp, &x_ps, &x_pf, &x_sA, &x_sB, &x_fA};
+	const double G[6] = {G_p, G_p, G_p, G_sA, G_sB, G_fA};
+
+	/* Noise of the pyramidal PSPs, see noise_xRK and noise_aRK */
+	const double g2	= gamma_p * gamma_p;
+	const double s3	= std::sqrt(3);
+	double xi[3], eta[3];
+	for (int M=0; M<3; ++M) {
+		xi[M]	= g2 * (Rand_vars[2*M] + Rand_vars[2*M+1]/s3);
+		eta[M]	= g2 * (Rand_vars[2*M] - Rand_vars[2*M+1]*s3)/4;
+	}
+
+	/* Initial values, values of the current stage and sums of the moments */
+	double y0[6], x0[6], y[6], x[6], sy[6], sx[6];
+	for (int i=0; i<6; ++i) {
+		y0[i] = y[i] = (*Y[i])[0];
+		x0[i] = x[i] = (*X[i])[0];
+		sy[i] = -3*y0[i];
+		sx[i] = -3*x0[i];
+	}
+
+	/* Weights of the moments in add_RK */
+	static constexpr double C[4] = {2, 4, 2, 1};
+	for (int N=0; N<4; ++N) {
+		const double h	= A[N]*dt;
+		const double hg	= h*gamma_p;
+
+		/* Firing rates, see get_Qp and get_Qs */
+		const double Qp = sigmoid(Qp_max, (N_pp * y[0] - N_sp * y[3] - N_fp * y[5] - theta_p) / sigma_p);
+		const double Qs = sigmoid(Qs_max, (N_ps * y[1] - N_ss * y[3] - theta_s) / sigma_s);
+		const double Q[6] = {Qp + afferent, Qp, Qp, Qs, Qs, Qs};
+
+		double y1[6], x1[6];
+		for (int i=0; i<6; ++i) {
+			y1[i] = y0[i] + h*(x[i]);
+			x1[i] = x0[i] + hg*(G[i] * (Q[i] - y[i]) - 2 * x[i]);
+		}
+		for (int M=0; M<3; ++M) {
+			x1[M] += xi[M]*B[N];
+		}
+		for (int i=0; i<6; ++i) {
+			y[i]	 = y1[i];
+			x[i]	 = x1[i];
+			sy[i]	+= C[N]*y1[i];
+			sx[i]	+= C[N]*x1[i];
+		}
+	}
+
+	for (int i=0; i<6; ++i) {
+		(*Y[i])[0] = sy[i]/6;
+		(*X[i])[0] = sx[i]/6;
+	}
+	for (int M=0; M<3; ++M) {
+		(*X[M])[0] += eta[M];
+	}
+
+	/* Generate noise for the next iteration */
+	next_noise();
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Exponential integrator										*/
+/****************************************************************************************************/
+void Cortical_Column::set_exponential(int k) {
+	if (k > PSP_Propagator::max_fixed_substeps) {
+		throw std::invalid_argument("Cortical_Column: exponential step longer than max_fixed_substeps");
+	}
+	set_propagators(Exp, k);
+}
+
+/* The inhibitory PSPs share the rise time of the pyramidal ones, as in set_RK */
+void Cortical_Column::set_propagators(Propagators& P, int k) const {
+	P[0].set(gamma_p, G_p,  k);
+	P[1].set(gamma_p, G_p,  k);
+	P[2].set(gamma_p, G_p,  k);
+	P[3].set(gamma_p, G_sA, k);
+	P[4].set(gamma_p, G_sB, k);
+	P[5].set(gamma_p, G_fA, k);
+}
+
+void Cortical_Column::exp_step(const Propagators& P) {
+	PROFILE_SCOPE(PROFILE_RK_CORTEX);
+	const double g2 = gamma_p * gamma_p;
+
+	/* Noise of the k steps of dt, with the increments of SRK4 */
+	double noise[3][4] = {};
+	for (int j=0; j<P[0].substeps(); ++j) {
+		for (int M=0; M<3; ++M) {
+			P[M].add_noise(j, g2 * (Rand_vars[2*M] + Rand_vars[2*M+1]/std::sqrt(3)), noise_aRK(M), noise[M]);
+		}
+		next_noise();
+	}
+	const double zero[4] = {0.0, 0.0, 0.0, 0.0};
+
+	/* Predictor */
+	const double Qp0 = get_Qp(0), Qs0 = get_Qs(0);
+	P[0].predict(y_pp.data(), x_pp.data(), Qp0 + afferent, noise[0]);
+	P[1].predict(y_ps.data(), x_ps.data(), Qp0, noise[1]);
+	P[2].predict(y_pf.data(), x_pf.data(), Qp0, noise[2]);
+	P[3].predict(y_sA.data(), x_sA.data(), Qs0, zero);
+	P[4].predict(y_sB.data(), x_sB.data(), Qs0, zero);
+	P[5].predict(y_fA.data(), x_fA.data(), Qs0, zero);
+
+	/* Collocation with the rates at the interior node and the end of the step */
+	for (int i=0; i<PSP_Propagator::iterations; ++i) {
+		const double Qpc = get_Qp(3), Qsc = get_Qs(3), Qp1 = get_Qp(2), Qs1 = get_Qs(2);
+		P[0].collocate(y_pp.data(), x_pp.data(), Qp0 + afferent, Qpc + afferent, Qp1 + afferent, noise[0]);
+		P[1].collocate(y_ps.data(), x_ps.data(), Qp0, Qpc, Qp1, noise[1]);
+		P[2].collocate(y_pf.data(), x_pf.data(), Qp0, Qpc, Qp1, noise[2]);
+		P[3].collocate(y_sA.data(), x_sA.data(), Qs0, Qsc, Qs1, zero);
+		P[4].collocate(y_sB.data(), x_sB.data(), Qs0, Qsc, Qs1, zero);
+		P[5].collocate(y_fA.data(), x_fA.data(), Qs0, Qsc, Qs1, zero);
 	}
+	P[0].accept(y_pp.data(), x_pp.data());
+	P[1].accept(y_ps.data(), x_ps.data());
+	P[2].accept(y_pf.data(), x_pf.data());
+	P[3].accept(y_sA.data(), x_sA.data());
+	P[4].accept(y_sB.data(), x_sB.data());
+	P[5].accept(y_fA.data(), x_fA.data());
 }
 /****************************************************************************************************/
 /*										 		end			 										*/
@@ -31,13 +31,18 @@
 /*									Header file of a cortical module							*/
 /************************************************************************************************/
 #pragma once
+#include <array>
 #include <cmath>
-#include <vector>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "PSP_Propagator.h"
 #include "Random_Stream.h"
-using std::vector;
+#include "Sigmoid.h"
+using std::array;
 
 /****************************************************************************************************/
-/*									Macro for vector initialization									*/
+/*									Macro for state initialization									*/
 /****************************************************************************************************/
 #ifndef _INIT
 #define _INIT(x)	{x, 0.0, 0.0, 0.0, 0.0}
@@ -55,13 +60,31 @@ public:
 	/* Constructors */
 	Cortical_Column(void)
 	{set_RNG();}
+	Cortical_Column(uint64_t seed, uint32_t realization = 0)
+	{set_RNG(seed, realization);}
 
-	/* Initialize the RNGs */
+	/* Initialize the RNGs, either from rand() or reproducibly from (seed, realization) */
 	void 	set_RNG		(void);
+	void 	set_RNG		(uint64_t seed, uint32_t realization);
 
 	/* Set strength of input */
 	void	set_input	(double I) {input = I;}
 
+	/* Firing rate of afferent pyramidal cells from other columns in ms^-1, enters the pyramidal	*/
+	/* excitatory PSP of the next RK stage, set by the network before every stage				*/
+	void	set_afferent(double phi) {afferent = phi;}
+
+	/* Binary snapshot of the complete state, load throws std::runtime_error on invalid data.	*/
+	/* After load the column continues bit-identically to the saved one. To fork realizations	*/
+	/* from a common state, call set_RNG(seed, realization) after load							*/
+	void	save		(std::ostream& out) const;
+	void	load		(std::istream& in);
+
+	/* Set a model parameter by name, returns false if the name is unknown. Every parameter		*/
+	/* below is accessible by its member name. A new dphi restarts the noise streams, so it		*/
+	/* should be set before the run. Only input and the connectivities are part of a snapshot	*/
+	bool	set_param	(const std::string& name, double value);
+
 	/* Firing rates */
 	double 	get_Qp		(int) const;
 	double 	get_Qs		(int) const;
@@ -83,78 +106,128 @@ public:
 	/* Noise function */
 	double 	noise_xRK 	(int, int) const;
 	double 	noise_aRK 	(int) const;
+	void	fill_noise	(void);
 
 	/* ODE functions */
 	void 	set_RK		(int);
 	void 	add_RK		(void);
 
+	/* Fused SRK4 step, bit identical to set_RK(0), ..., set_RK(3) and add_RK for a constant	*/
+	/* afferent rate. Every firing rate and noise term is evaluated once per stage and only the	*/
+	/* new state is stored, the moments 1 to 4 are left untouched								*/
+	void	step		(void);
+
+	/* Exponential integrator, the linear PSP dynamics are propagated exactly over steps of k*dt	*/
+	/* and only the firing rates are integrated numerically, see PSP_Propagator.h. set_exponential	*/
+	/* throws std::invalid_argument if k is not in [1, PSP_Propagator::max_fixed_substeps], longer	*/
+	/* fixed steps bias the bursts of CA3. Steps with external propagators from set_propagators	*/
+	/* may change k from step to step up to PSP_Propagator::max_substeps						*/
+	typedef array<PSP_Propagator, 6> Propagators;
+	void	set_exponential	(int k);
+	void	set_propagators	(Propagators& P, int k) const;
+	void	exp_step		(void) {exp_step(Exp);}
+	void	exp_step		(const Propagators& P);
+
 	/* Data storage  access */
 	void	get_data (int N, double* V) {V[N] = N_pp * y_pp[0] - N_fp * y_fA[0] - N_sp * (y_sA[0] + y_sB[0]);}
+	/* Time derivative of the output, slope for the dense output of exp_step */
+	void	get_slope(double* V) const {
+		V[0] = N_pp * x_pp[0] - N_fp * x_fA[0] - N_sp * (x_sA[0] + x_sB[0]);
+	}
+	/* Embedded error estimate of the output of the last exp_step, corrector minus predictor */
+	void	get_error(double* V) const {
+		V[0] = N_pp * (y_pp[0] - y_pp[1]) - N_fp * (y_fA[0] - y_fA[1]) - N_sp * (y_sA[0] - y_sA[1] + y_sB[0] - y_sB[1]);
+	}
 	/* Stimulation protocoll acces */
 	friend class Stim;
 
 private:
+	/* Fields of a snapshot besides the noise streams */
+	template <typename Archive, typename Column>
+	static void	snapshot_fields	(Archive& ar, Column& c);
+
+	/* Draws the noise of the next step of dt */
+	void	next_noise		(void);
+
+	/* Updates the state that depends on a parameter */
+	void	refresh_param	(const std::string& name);
+
+	/* Number of noise streams, I_{l} and I_{l,0} for every noisy PSP */
+	static const int N_noise = 6;
+
 	/* Random number generators */
-	vector<random_stream_normal> MTRands;
+	array<random_stream_philox, N_noise> Rands;
 
 	/* Container for noise */
-	vector<double>	Rand_vars;
+	array<double, N_noise> Rand_vars;
+
+	/* Block of pre-generated noise, stream i holds the draws of the next steps at	*/
+	/* [i*noise_block, (i+1)*noise_block), noise_pos is the next step to be used	*/
+	static const int noise_block = 64;
+	array<double, N_noise*noise_block> Noise;
+	int				noise_pos	 = 0;
+
+	/* Exact propagators of y_pp, y_ps, y_pf, y_sA, y_sB and y_fA */
+	Propagators		Exp;
 
 	/* Declaration and Initialization of parameters */
 	/* Membrane time in ms */
-	const double 	tau_p 		= 3;
-	const double 	tau_s 		= 3;
-	const double 	tau_f 		= 3;
+	double			tau_p 		= 3;
+	double			tau_s 		= 3;
+	double			tau_f 		= 3;
 
 	/* Maximum firing rate in ms^-1 */
-	const double 	Qp_max		= 5.E-3;
-	const double 	Qs_max		= 5.E-3;
-	const double 	Qf_max		= 5.E-3;
+	double			Qp_max		= 5.E-3;
+	double			Qs_max		= 5.E-3;
+	double			Qf_max		= 5.E-3;
 
 	/* Sigmoid threshold in mV */
-	const double 	theta_p		= 1;
-	const double 	theta_s		= 6;
-	const double 	theta_f		= 6;
+	double			theta_p		= 1;
+	double			theta_s		= 6;
+	double			theta_f		= 6;
 
 	/* Sigmoid gain in mV */
-	const double 	sigma_p		= 0.56;
-	const double 	sigma_s		= 0.56;
-	const double 	sigma_f		= 0.56;
+	double			sigma_p		= 0.56;
+	double			sigma_s		= 0.56;
+	double			sigma_f		= 0.56;
 
 	/* PSP rise time in ms^-1 */
-	const double 	gamma_p		= 180E-3;
-	const double 	gamma_sA	= 33E-3;
-	const double 	gamma_fA	= 220E-3;
-	const double 	gamma_sB	= 3.3E-3;
+	double			gamma_p		= 180E-3;
+	double			gamma_sA	= 33E-3;
+	double			gamma_fA	= 220E-3;
+	double			gamma_sB	= 3.3E-3;
 
 	/* PSP amplitudes in mV */
-	const double 	G_p         = 5;
-	const double 	G_sA        = 50;
-	const double 	G_fA        = 20;
-	const double 	G_sB        = 3;
+	double			G_p         = 5;
+	double			G_sA        = 50;
+	double			G_fA        = 20;
+	double			G_sB        = 3;
 
 	/* Noise parameters in ms^-1 */
-	const double	dphi		= 5E-3;
+	double			dphi		= 5E-3;
 	double			input		= 0.0;
 
-	/* Connectivities (dimensionless) */
-	const double 	N_pp		= 200;
-	const double 	N_ps		= 200;
-	const double 	N_pf		= 200;
-	const double 	N_sp		= 240;
-	const double 	N_ss		= 400;
-	const double 	N_sf		= 400;
-	const double 	N_fp		= 100;
-	const double 	N_ff		= 100;
+	/* Afferent firing rate of the current RK stage */
+	double			afferent	= 0.0;
+
+	/* Connectivities (dimensionless), variable for parameter sweeps */
+	double 			N_pp		= 200;
+	double 			N_ps		= 200;
+	double 			N_pf		= 200;
+	double 			N_sp		= 240;
+	double 			N_ss		= 400;
+	double 			N_sf		= 400;
+	double 			N_fp		= 100;
+	double 			N_ff		= 100;
 
 	/* Parameters for SRK4 iteration */
-	const vector<double> A = {0.5,  0.5,  1.0, 1.0};
-	const vector<double> B = {0.75, 0.75, 0.0, 0.0};
+	static constexpr double A[4] = {0.5,  0.5,  1.0, 1.0};
+	static constexpr double B[4] = {0.75, 0.75, 0.0, 0.0};
 
 	/* Population variables															*/
 	/* Excitatory PSPs have to be treated individually as they are noisy.           */
 	/* In contrast inhibitory PSP are noise free and therewith only computed once   */
-	vector<double> 	y_pp	= _INIT(0.0),		/* Pyramidal to p  AMPA  PSP        */
+	array<double, 5> y_pp	= _INIT(0.0),		/* Pyramidal to p  AMPA  PSP        */
 					y_ps	= _INIT(0.0),		/* Pyramidal to s  AMPA  PSP        */
 					y_pf	= _INIT(0.0),		/* Pyramidal to f  AMPA  PSP        */
 					y_sA	= _INIT(0.0),		/* Slow inhibitory GABAA PSP        */
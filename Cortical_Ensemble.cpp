@@ -0,0 +1,335 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Functions of the cortical ensemble								*/
+/****************************************************************************************************/
+#include <utility>
+#include "Cortical_Ensemble.h"
+#include "Profiler.h"
+#include "SRK_Moments.h"
+
+/* Parameters for SRK4 iteration */
+template <typename T, typename S> constexpr double Cortical_Ensemble_T<T, S>::A[4];
+template <typename T, typename S> constexpr double Cortical_Ensemble_T<T, S>::B[4];
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+template <typename T, typename S>
+Cortical_Ensemble_T<T, S>::Cortical_Ensemble_T(int R)
+: Cortical_Ensemble_T(R, rand())
+{}
+
+template <typename T, typename S>
+Cortical_Ensemble_T<T, S>::Cortical_Ensemble_T(int R, uint64_t seed)
+: R		(R),
+  Qp	(R), Qs	  (R),
+  y_pp	(5*R), y_ps (5*R), y_pf (5*R), y_sA (5*R), y_sB (5*R), y_fA (5*R),
+  x_pp	(5*R), x_ps (5*R), x_pf (5*R), x_sA (5*R), x_sB (5*R), x_fA (5*R)
+{
+	/* Accumulated state of the mixed precision, all variables start at 0 */
+	State.resize(mixed ? N_VARS*R : 0);
+	set_RNG(seed);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Parameter access 											*/
+/****************************************************************************************************/
+template <typename T, typename S>
+bool Cortical_Ensemble_T<T, S>::set_param(const std::string& name, double value) {
+	typedef Cortical_Ensemble_T<T, S> C;
+	static const std::pair<const char*, T C::*> params[] = {
+		{"tau_p",	&C::tau_p},		{"tau_s",	&C::tau_s},		{"tau_f",	&C::tau_f},
+		{"Qp_max",	&C::Qp_max},	{"Qs_max",	&C::Qs_max},	{"Qf_max",	&C::Qf_max},
+		{"theta_p",	&C::theta_p},	{"theta_s",	&C::theta_s},	{"theta_f",	&C::theta_f},
+		{"sigma_p",	&C::sigma_p},	{"sigma_s",	&C::sigma_s},	{"sigma_f",	&C::sigma_f},
+		{"gamma_p",	&C::gamma_p},	{"gamma_sA",&C::gamma_sA},	{"gamma_fA",&C::gamma_fA},
+		{"gamma_sB",&C::gamma_sB},	{"G_p",		&C::G_p},		{"G_sA",	&C::G_sA},
+		{"G_fA",	&C::G_fA},		{"G_sB",	&C::G_sB},		{"N_pp",	&C::N_pp},
+		{"N_ps",	&C::N_ps},		{"N_pf",	&C::N_pf},		{"N_sp",	&C::N_sp},
+		{"N_ss",	&C::N_ss},		{"N_sf",	&C::N_sf},		{"N_fp",	&C::N_fp},
+		{"N_ff",	&C::N_ff}};
+	for (const auto& p : params) {
+		if (name == p.first) {
+			this->*p.second = value;
+			return true;
+		}
+	}
+
+	/* The noise parameters stay in double, a new dphi restarts the streams as in the column */
+	if (name == "input") {
+		input = value;
+		return true;
+	}
+	if (name == "dphi") {
+		dphi = value;
+		set_RNG(seed);
+		return true;
+	}
+	return false;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Initialization of RNG 										*/
+/****************************************************************************************************/
+template <typename T, typename S>
+void Cortical_Ensemble_T<T, S>::set_RNG(uint64_t seed) {
+	/* Number of independent random variables */
+	int N = 3;
+
+	/* Every realization uses the streams (seed, r, column, s), all at the same position */
+	this->seed	= seed;
+	position	= 0;
+	Rand_vars.resize(2*N*R);
+	Normals.resize(R);
+	Spare.resize(2*N*R);
+
+	/* Get the random number for the first iteration */
+	draw_noise(0.0);
+}
+
+/* The streams of all realizations are generated as one block per stream and position */
+template <typename T, typename S>
+void Cortical_Ensemble_T<T, S>::draw_noise(double shift) {
+	PROFILE_SCOPE(PROFILE_NOISE);
+	extern const double dt;
+	const int M = Rand_vars.size()/R;
+	for (int s=0; s<M; ++s) {
+		T* __restrict__ z			= &Rand_vars[s*R];
+		double* __restrict__ g		= &Normals[0];
+		double* __restrict__ spare	= &Spare[s*R];
+		if (position & 1) {
+			g = spare;
+		} else {
+			random_stream_philox::normal_pairs(position >> 1, seed, RNG_CORTEX, s, R, g, spare);
+		}
+
+		/* Even streams are I_{l}, odd streams I_{l,0} */
+		const double stddev = s%2 ? dt : dphi*dt;
+		for (int r=0; r<R; ++r) {
+			z[r] = T(0.0 + stddev * g[r] + shift);
+		}
+	}
+	++position;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Firing Rate functions 										*/
+/****************************************************************************************************/
+template <typename T, typename S>
+void Cortical_Ensemble_T<T, S>::set_Q (int N) {
+	const T* __restrict__ ypp = stage(y_pp, N);
+	const T* __restrict__ yps = stage(y_ps, N);
+	const T* __restrict__ ysA = stage(y_sA, N);
+	const T* __restrict__ yfA = stage(y_fA, N);
+	T* __restrict__ qp = &Qp[0];
+	T* __restrict__ qs = &Qs[0];
+
+	/* Local copies of the parameters, otherwise they are reloaded in every iteration as the stores	*/
+	/* might alias the members, which prevents vectorization										*/
+	const T N_pp = this->N_pp, N_ps = this->N_ps, N_sp = this->N_sp, N_ss = this->N_ss, N_fp = this->N_fp;
+	const T theta_p = this->theta_p, theta_s = this->theta_s, sigma_p = this->sigma_p, sigma_s = this->sigma_s;
+
+	/* Arguments of the sigmoids */
+	for (int r=0; r<R; ++r) {
+		/* Pyramidal firing rate */
+		qp[r] = (N_pp * ypp[r] - N_sp * ysA[r] - N_fp * yfA[r] - theta_p) / sigma_p;
+		/* Slow inhibitory firing rate */
+		qs[r] = (N_ps * yps[r] - N_ss * ysA[r] - theta_s) / sigma_s;
+	}
+
+	sigmoid(Qp_max, qp, qp, R);
+	sigmoid(Qs_max, qs, qs, R);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Calculate the Nth SRK term									*/
+/****************************************************************************************************/
+template <typename T, typename S>
+void Cortical_Ensemble_T<T, S>::set_RK (int N) {
+	PROFILE_SCOPE(PROFILE_ENSEMBLE);
+	extern const double dt;
+	set_Q(N);
+
+	/* Step sizes and noise scaling of the Nth moment */
+	const T h	= A[N]*dt;
+	const T hg	= h*gamma_p;
+	const T g2	= gamma_p * gamma_p;
+	const T s3	= std::sqrt(T(3));
+	const T b	= B[N];
+
+	const T* __restrict__ qp = &Qp[0];
+	const T* __restrict__ qs = &Qs[0];
+
+	/* Noise of the pyramidal streams */
+	const T* __restrict__ n0 = &Rand_vars[0*R];
+	const T* __restrict__ n1 = &Rand_vars[1*R];
+	const T* __restrict__ n2 = &Rand_vars[2*R];
+	const T* __restrict__ n3 = &Rand_vars[3*R];
+	const T* __restrict__ n4 = &Rand_vars[4*R];
+	const T* __restrict__ n5 = &Rand_vars[5*R];
+
+	/* Initial values */
+	const T* __restrict__ ypp0 = stage(y_pp, 0);
+	const T* __restrict__ yps0 = stage(y_ps, 0);
+	const T* __restrict__ ypf0 = stage(y_pf, 0);
+	const T* __restrict__ ysA0 = stage(y_sA, 0);
+	const T* __restrict__ ysB0 = stage(y_sB, 0);
+	const T* __restrict__ yfA0 = stage(y_fA, 0);
+	const T* __restrict__ xpp0 = stage(x_pp, 0);
+	const T* __restrict__ xps0 = stage(x_ps, 0);
+	const T* __restrict__ xpf0 = stage(x_pf, 0);
+	const T* __restrict__ xsA0 = stage(x_sA, 0);
+	const T* __restrict__ xsB0 = stage(x_sB, 0);
+	const T* __restrict__ xfA0 = stage(x_fA, 0);
+
+	/* Values of the Nth moment */
+	const T* __restrict__ ypp = stage(y_pp, N);
+	const T* __restrict__ yps = stage(y_ps, N);
+	const T* __restrict__ ypf = stage(y_pf, N);
+	const T* __restrict__ ysA = stage(y_sA, N);
+	const T* __restrict__ ysB = stage(y_sB, N);
+	const T* __restrict__ yfA = stage(y_fA, N);
+	const T* __restrict__ xpp = stage(x_pp, N);
+	const T* __restrict__ xps = stage(x_ps, N);
+	const T* __restrict__ xpf = stage(x_pf, N);
+	const T* __restrict__ xsA = stage(x_sA, N);
+	const T* __restrict__ xsB = stage(x_sB, N);
+	const T* __restrict__ xfA = stage(x_fA, N);
+
+	/* Values of the (N+1)th moment */
+	T* __restrict__ ypp1 = stage(y_pp, N+1);
+	T* __restrict__ yps1 = stage(y_ps, N+1);
+	T* __restrict__ ypf1 = stage(y_pf, N+1);
+	T* __restrict__ ysA1 = stage(y_sA, N+1);
+	T* __restrict__ ysB1 = stage(y_sB, N+1);
+	T* __restrict__ yfA1 = stage(y_fA, N+1);
+	T* __restrict__ xpp1 = stage(x_pp, N+1);
+	T* __restrict__ xps1 = stage(x_ps, N+1);
+	T* __restrict__ xpf1 = stage(x_pf, N+1);
+	T* __restrict__ xsA1 = stage(x_sA, N+1);
+	T* __restrict__ xsB1 = stage(x_sB, N+1);
+	T* __restrict__ xfA1 = stage(x_fA, N+1);
+
+	/* Local copies of the parameters, otherwise they are reloaded in every iteration as the stores	*/
+	/* might alias the members. GCC ignores __restrict__ on local pointers, ivdep states that the	*/
+	/* moments do not overlap, which is needed for vectorization									*/
+	const T G_p = this->G_p, G_sA = this->G_sA, G_sB = this->G_sB, G_fA = this->G_fA;
+
+	#pragma GCC ivdep
+	for (int r=0; r<R; ++r) {
+		ypp1[r] = ypp0[r] + h*(xpp[r]);
+		yps1[r] = yps0[r] + h*(xps[r]);
+		ypf1[r] = ypf0[r] + h*(xpf[r]);
+		ysA1[r] = ysA0[r] + h*(xsA[r]);
+		ysB1[r] = ysB0[r] + h*(xsB[r]);
+		yfA1[r] = yfA0[r] + h*(xfA[r]);
+		xpp1[r] = xpp0[r] + hg*(G_p * (qp[r] - ypp[r]) - 2 * xpp[r]) + g2 * (n0[r] + n1[r]/s3)*b;
+		xps1[r] = xps0[r] + hg*(G_p * (qp[r] - yps[r]) - 2 * xps[r]) + g2 * (n2[r] + n3[r]/s3)*b;
+		xpf1[r] = xpf0[r] + hg*(G_p * (qp[r] - ypf[r]) - 2 * xpf[r]) + g2 * (n4[r] + n5[r]/s3)*b;
+		xsA1[r] = xsA0[r] + hg*(G_sA* (qs[r] - ysA[r]) - 2 * xsA[r]);
+		xsB1[r] = xsB0[r] + hg*(G_sB* (qs[r] - ysB[r]) - 2 * xsB[r]);
+		xfA1[r] = xfA0[r] + hg*(G_fA* (qs[r] - yfA[r]) - 2 * xfA[r]);
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Function that adds all SRK terms								*/
+/****************************************************************************************************/
+template <typename T, typename S>
+void Cortical_Ensemble_T<T, S>::add_RK(void) {
+	PROFILE_SCOPE(PROFILE_ENSEMBLE);
+	const T g2	= gamma_p * gamma_p;
+	if (mixed) {
+		S* acc = &State[0];
+		add_moments(&y_pp[0], acc + Y_PP*R, R);
+		add_moments(&y_ps[0], acc + Y_PS*R, R);
+		add_moments(&y_pf[0], acc + Y_PF*R, R);
+		add_moments(&y_sA[0], acc + Y_SA*R, R);
+		add_moments(&y_sB[0], acc + Y_SB*R, R);
+		add_moments(&y_fA[0], acc + Y_FA*R, R);
+		add_moments(&x_pp[0], acc + X_PP*R, &Rand_vars[0*R], &Rand_vars[1*R], g2, R);
+		add_moments(&x_ps[0], acc + X_PS*R, &Rand_vars[2*R], &Rand_vars[3*R], g2, R);
+		add_moments(&x_pf[0], acc + X_PF*R, &Rand_vars[4*R], &Rand_vars[5*R], g2, R);
+		add_moments(&x_sA[0], acc + X_SA*R, R);
+		add_moments(&x_sB[0], acc + X_SB*R, R);
+		add_moments(&x_fA[0], acc + X_FA*R, R);
+	} else {
+		add_moments(&y_pp[0], R);
+		add_moments(&y_ps[0], R);
+		add_moments(&y_pf[0], R);
+		add_moments(&y_sA[0], R);
+		add_moments(&y_sB[0], R);
+		add_moments(&y_fA[0], R);
+		add_moments(&x_pp[0], &Rand_vars[0*R], &Rand_vars[1*R], g2, R);
+		add_moments(&x_ps[0], &Rand_vars[2*R], &Rand_vars[3*R], g2, R);
+		add_moments(&x_pf[0], &Rand_vars[4*R], &Rand_vars[5*R], g2, R);
+		add_moments(&x_sA[0], R);
+		add_moments(&x_sB[0], R);
+		add_moments(&x_fA[0], R);
+	}
+
+	/* Generate noise for the next iteration */
+	draw_noise(input);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Instantiation of the precisions									*/
+/****************************************************************************************************/
+template class Cortical_Ensemble_T<double>;
+template class Cortical_Ensemble_T<float>;
+template class Cortical_Ensemble_T<float, double>;
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
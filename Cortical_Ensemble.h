@@ -0,0 +1,187 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/************************************************************************************************/
+/*							Header file of an ensemble of cortical modules						*/
+/*																								*/
+/*		Holds R independent noisy realizations of Cortical_Column in structure-of-arrays form.	*/
+/*		Every state variable is one contiguous array of length 5*R, where the entries of the	*/
+/*		k-th SRK moment are stored in [k*R, (k+1)*R). Thereby every SRK stage is a single		*/
+/*		pass over contiguous memory for all realizations.										*/
+/*																								*/
+/*		The moments are stored in the scalar type T. With S = T the step is that of the column,	*/
+/*		with T = float, S = double (mixed precision) the new state is accumulated in double		*/
+/*		from the increments of the moments, so rounding errors do not add up over the run.		*/
+/************************************************************************************************/
+#pragma once
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Random_Stream.h"
+#include "Sigmoid.h"
+using std::vector;
+
+
+/****************************************************************************************************/
+/*								Implementation of the cortical ensemble 							*/
+/****************************************************************************************************/
+template <typename T, typename S = T>
+class Cortical_Ensemble_T {
+public:
+	/* Constructors, realization r is keyed by (seed, r) and matches the column seeded alike */
+	Cortical_Ensemble_T(int R);
+	Cortical_Ensemble_T(int R, uint64_t seed);
+
+	/* Initialize the RNGs */
+	void 	set_RNG		(uint64_t seed);
+
+	/* Set strength of input */
+	void	set_input	(double I) {input = I;}
+
+	/* Set a model parameter of all realizations by name, with the names of					*/
+	/* Cortical_Column::set_param. Returns false if the name is unknown						*/
+	bool	set_param	(const std::string& name, double value);
+
+	/* Number of realizations */
+	int		size		(void) const {return R;}
+
+	/* ODE functions */
+	void 	set_RK		(int);
+	void 	add_RK		(void);
+
+	/* Data storage  access */
+	void	get_data (int N, int r, double* V) const
+	{V[N] = N_pp * value(y_pp, Y_PP, r) - N_fp * value(y_fA, Y_FA, r)
+		  - N_sp * (value(y_sA, Y_SA, r) + value(y_sB, Y_SB, r));}
+
+private:
+	/* Firing rates of all realizations at the Nth SRK moment */
+	void 	set_Q		(int);
+
+	/* Pointer to the Nth SRK moment of a state variable */
+	T*	 			stage	(vector<T>& x, int N) 		 {return &x[N*R];}
+	const T*		stage	(const vector<T>& x, int N) const {return &x[N*R];}
+
+	/* Current value of variable k, the accumulated one in mixed precision */
+	S				value	(const vector<T>& x, int k, int r) const
+	{return mixed ? State[k*R+r] : x[r];}
+
+	/* Number of realizations */
+	const int		R;
+
+	/* Draw the noise of all realizations at the current position of the streams */
+	void	draw_noise	(double shift);
+
+	/* Key and common position of the noise streams, 6 per realization */
+	uint64_t		seed;
+	uint64_t		position;
+
+	/* Container for noise, stream s of realization r is stored at [s*R + r] */
+	vector<T>		Rand_vars;
+
+	/* Normals of the current position and second normal of every Box-Muller pair, used by the	*/
+	/* odd positions. Both are generated in double precision regardless of T					*/
+	vector<double>	Normals;
+	vector<double>	Spare;
+
+	/* In mixed precision the SRK moments are stored in T, while the new state is accumulated	*/
+	/* in S. Variable k of realization r is stored at [k*R + r], see add_RK for the order		*/
+	static constexpr bool mixed = !std::is_same<T, S>::value;
+	vector<S>		State;
+
+	/* Firing rates of the current SRK moment */
+	vector<T>		Qp, Qs;
+
+	/* Declaration and Initialization of parameters */
+	/* Membrane time in ms */
+	T 				tau_p 		= 3;
+	T 				tau_s 		= 3;
+	T 				tau_f 		= 3;
+
+	/* Maximum firing rate in ms^-1 */
+	T 				Qp_max		= 5.E-3;
+	T 				Qs_max		= 5.E-3;
+	T 				Qf_max		= 5.E-3;
+
+	/* Sigmoid threshold in mV */
+	T 				theta_p		= 1;
+	T 				theta_s		= 6;
+	T 				theta_f		= 6;
+
+	/* Sigmoid gain in mV */
+	T 				sigma_p		= 0.56;
+	T 				sigma_s		= 0.56;
+	T 				sigma_f		= 0.56;
+
+	/* PSP rise time in ms^-1 */
+	T 				gamma_p		= 180E-3;
+	T 				gamma_sA	= 33E-3;
+	T 				gamma_fA	= 220E-3;
+	T 				gamma_sB	= 3.3E-3;
+
+	/* PSP amplitudes in mV */
+	T 				G_p         = 5;
+	T 				G_sA        = 50;
+	T 				G_fA        = 20;
+	T 				G_sB        = 3;
+
+	/* Noise parameters in ms^-1 */
+	double			dphi		= 5E-3;
+	double			input		= 0.0;
+
+	/* Connectivities (dimensionless) */
+	T 				N_pp		= 200;
+	T 				N_ps		= 200;
+	T 				N_pf		= 200;
+	T 				N_sp		= 240;
+	T 				N_ss		= 400;
+	T 				N_sf		= 400;
+	T 				N_fp		= 100;
+	T 				N_ff		= 100;
+
+	/* Parameters for SRK4 iteration */
+	static constexpr double A[4] = {0.5,  0.5,  1.0, 1.0};
+	static constexpr double B[4] = {0.75, 0.75, 0.0, 0.0};
+
+	/* Population variables, see Cortical_Column */
+	vector<T> 		y_pp, y_ps, y_pf, y_sA, y_sB, y_fA,
+					x_pp, x_ps, x_pf, x_sA, x_sB, x_fA;
+
+	/* Index of the variables in State */
+	enum Variable	{Y_PP, Y_PS, Y_PF, Y_SA, Y_SB, Y_FA, X_PP, X_PS, X_PF, X_SA, X_SB, X_FA, N_VARS};
+};
+
+/* Double precision reference, float and mixed precision ensembles */
+typedef Cortical_Ensemble_T<double>			Cortical_Ensemble;
+typedef Cortical_Ensemble_T<float>			Cortical_Ensemble_Float;
+typedef Cortical_Ensemble_T<float, double>	Cortical_Ensemble_Mixed;
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
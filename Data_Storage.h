@@ -31,17 +31,94 @@
 /*									Functions for data storage										*/
 /****************************************************************************************************/
 #pragma once
+#include <fstream>
+#include <stdexcept>
+#include <string>
 #include "CA3_Column.h"
+#include "CA3_Ensemble.h"
 #include "Cortical_Column.h"
+#include "Cortical_Ensemble.h"
+#include "Decimator.h"
+#include "HFO_Detector.h"
+#include "Profiler.h"
+#include "Trace_Writer.h"
 
 /****************************************************************************************************/
 /*											Save data												*/
 /****************************************************************************************************/
 inline void get_data(int counter, Cortical_Column& C,  CA3_Column& CA3, 
 					 double* V_C, double* V_H, double * Y_H) {
+	PROFILE_SCOPE(PROFILE_STORAGE);
 	C.get_data(counter, V_C);
 	CA3.get_data(counter, V_H, Y_H);
 }
+
+/* Saves the data of realization r of an ensemble */
+template <typename T, typename S>
+inline void get_data(int counter, int r, const Cortical_Ensemble_T<T, S>& C, const CA3_Ensemble_T<T, S>& CA3,
+					 double* V_C, double* V_H, double * Y_H) {
+	PROFILE_SCOPE(PROFILE_STORAGE);
+	C.get_data(counter, r, V_C);
+	CA3.get_data(counter, r, V_H, Y_H);
+}
+
+/* Streams the current frame (V_C, V_H, Y_H) to a trace writer */
+inline void get_data(Trace_Writer& W, Cortical_Column& C, CA3_Column& CA3) {
+	PROFILE_SCOPE(PROFILE_STORAGE);
+	double frame[3];
+	C.get_data(0, frame);
+	CA3.get_data(0, frame+1, frame+2);
+	W.push(frame);
+}
+
+/* Feeds V_H to an online HFO detector */
+inline void get_data(HFO_Detector& D, CA3_Column& CA3) {
+	PROFILE_SCOPE(PROFILE_STORAGE);
+	double V, Y;
+	CA3.get_data(0, &V, &Y);
+	D.push(V);
+}
+
+/* Feeds the frame (V_C, V_H, Y_H) to per channel recorders, possibly at reduced rates. The step	*/
+/* is counted from the first recorded time step, earlier steps only fill the filters				*/
+inline void get_data(int step, Channel_Recorder* R, Cortical_Column& C, CA3_Column& CA3) {
+	PROFILE_SCOPE(PROFILE_STORAGE);
+	double frame[3];
+	C.get_data(0, frame);
+	CA3.get_data(0, frame+1, frame+2);
+	for (int i=0; i<3; ++i) {
+		if (step >= -R[i].lead()) {
+			R[i].push(frame[i]);
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end													*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Snapshots of the simulation									*/
+/****************************************************************************************************/
+/* Stores the state of both columns, throws std::runtime_error on failure */
+inline void save_state(const std::string& file, const Cortical_Column& C, const CA3_Column& CA3) {
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		throw std::runtime_error("cannot create snapshot " + file);
+	}
+	C.save(out);
+	CA3.save(out);
+}
+
+/* Restores the state of both columns, throws std::runtime_error on failure */
+inline void load_state(const std::string& file, Cortical_Column& C, CA3_Column& CA3) {
+	std::ifstream in(file, std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("cannot open snapshot " + file);
+	}
+	C.load(in);
+	CA3.load(in);
+}
 /****************************************************************************************************/
 /*										 		end													*/
 /****************************************************************************************************/
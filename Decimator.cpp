@@ -0,0 +1,102 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Implementation of the decimator									*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include "Decimator.h"
+
+/****************************************************************************************************/
+/*										Filter design												*/
+/****************************************************************************************************/
+/* Modified Bessel function of order zero, power series */
+static double bessel_i0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k=1; k<50 && term > 1E-17*sum; ++k) {
+		term *= (x/(2*k)) * (x/(2*k));
+		sum  += term;
+	}
+	return sum;
+}
+
+Decimator::Decimator(int factor, int taps_per_phase, double cutoff, int start)
+: M		(std::max(factor, 1)),
+  L		(M == 1 ? 1 : std::max(taps_per_phase, 2)*M - 1),
+  start	(start),
+  h		(L),
+  history(2*L, 0.0) {
+	/* Kaiser window with beta = 8, about 80 dB stopband attenuation */
+	const double	beta	= 8.0;
+	const double	fc		= cutoff * 0.5 / M;
+	const double	mid		= (L-1)/2.0;
+	double			sum		= 0.0;
+	for (int k=0; k<L; ++k) {
+		const double t	= k - mid;
+		const double r	= L > 1 ? t/mid : 0.0;
+		const double w	= bessel_i0(beta*std::sqrt(std::max(0.0, 1.0 - r*r))) / bessel_i0(beta);
+		const double s	= t == 0.0 ? 2*fc : std::sin(2*M_PI*fc*t)/(M_PI*t);
+		h[k] = w*s;
+		sum	+= h[k];
+	}
+	for (int k=0; k<L; ++k) {
+		h[k] /= sum;
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Filtering													*/
+/****************************************************************************************************/
+bool Decimator::push(double x, double& y) {
+	/* Newest sample at pos+L-1 (and pos-1), oldest at pos */
+	history[pos] = history[pos+L] = x;
+	pos = pos+1 == L ? 0 : pos+1;
+
+	const long long k = n++ - start;
+	if (k < 0 || k % M) {
+		return false;
+	}
+
+	/* The filter is symmetric, so the order of the history does not matter */
+	const double* __restrict__ window = &history[pos];
+	double sum = 0.0;
+	for (int i=0; i<L; ++i) {
+		sum += h[i] * window[i];
+	}
+	y = sum;
+	return true;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
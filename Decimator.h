@@ -0,0 +1,117 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Streaming decimation										*/
+/*																									*/
+/*		A channel that is stored at 1/M of the integration rate is passed through a linear phase	*/
+/*		lowpass FIR filter before it is downsampled, so that no power above the new Nyquist		*/
+/*		frequency folds back into the recorded band. Only every Mth output of the filter is		*/
+/*		evaluated, which is the cost of a polyphase implementation, L/M multiply-adds per input	*/
+/*		sample for L taps. The filter is a Kaiser windowed sinc with unit gain at DC.				*/
+/****************************************************************************************************/
+#pragma once
+#include <vector>
+using std::vector;
+
+/****************************************************************************************************/
+/*										Decimating FIR filter										*/
+/****************************************************************************************************/
+class Decimator {
+public:
+	/* Constructors, decimation by factor with taps_per_phase*factor - 1 taps. The cutoff is given	*/
+	/* relative to the output Nyquist frequency, the first output is produced for input start		*/
+	Decimator(int factor, int taps_per_phase = 48, double cutoff = 0.9, int start = 0);
+
+	/* Feed one input sample, returns true if an output y is due */
+	bool	push	(double x, double& y);
+
+	/* Decimation factor and group delay of the filter in input samples */
+	int		factor	(void) const {return M;}
+	int		delay	(void) const {return (L-1)/2;}
+	static int	delay	(int factor, int taps_per_phase) {return (taps_per_phase*factor - 2)/2;}
+
+private:
+	const int		M;
+	const int		L;
+	const int		start;
+
+	/* Filter coefficients, symmetric */
+	vector<double>	h;
+
+	/* History of the last L inputs, stored twice so that it is contiguous from any position */
+	vector<double>	history;
+	int				pos	= 0;
+	long long		n	= 0;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Decimated channel storage									*/
+/****************************************************************************************************/
+/* Writes a channel at 1/factor of the input rate to a caller provided array of length size. The	*/
+/* filter delay is compensated, so the input has to start lead() samples before the first		*/
+/* recorded time step and out[m] then belongs to the same time as input step m*factor after		*/
+/* that. Accordingly the input has to continue lead() samples past the last recorded step.		*/
+class Channel_Recorder {
+public:
+	Channel_Recorder(double* out, int size, int factor)
+	: out(out), capacity(size),
+	  filter(factor, 48, 0.9, factor > 1 ? 2*Decimator::delay(factor, 48) : 0) {}
+
+	/* Number of samples to feed before the first and after the last recorded time step */
+	int		lead	(void) const {return filter.factor() > 1 ? filter.delay() : 0;}
+
+	/* Number of stored samples and whether the array is full */
+	int		size	(void) const {return count;}
+	bool	full	(void) const {return count == capacity;}
+
+	void	push	(double x) {
+		if (full()) {
+			return;
+		}
+		if (filter.factor() == 1) {
+			out[count++] = x;
+		} else if (filter.push(x, out[count])) {
+			++count;
+		}
+	}
+
+private:
+	double*		out;
+	const int	capacity;
+	Decimator	filter;
+	int			count	= 0;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
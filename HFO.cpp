@@ -32,8 +32,14 @@
 /****************************************************************************************************/
 #include <iostream>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
 #include "Data_Storage.h"
 #include "ODE.h"
+#include "Parameters.h"
+#include "Validation.h"
 
 /****************************************************************************************************/
 /*										Fixed simulation settings									*/
@@ -50,18 +56,211 @@ extern const double dt 	= 1E3/res;
 /****************************************************************************************************/
 /*										Main simulation routine										*/
 /****************************************************************************************************/
-int main(void) {
+int main(int argc, char* argv[]) {
+	/* Command line options:													*/
+	/*		--sigmoid=libm|scalar|avx2|avx512|auto	kernel of the firing rates	*/
+	/*		--validate-sigmoid						compare kernel against libm	*/
+	/*		--validate-precision=float|mixed		ensemble drift vs double	*/
+	/*		--validate-equivalence=R				fast paths vs reference at	*/
+	/*												--params or hfo_params, exit*/
+	/*												code 1 on divergence		*/
+	/*		--validate-exponential=k				exponential at k*dt vs SRK4	*/
+	/*												at --params or hfo_params	*/
+	/*		--exponential=k							exponential integrator with	*/
+	/*												steps of k*dt, k <= 4		*/
+	/*		--validate-adaptive=atol				adaptive at atol vs SRK4 at	*/
+	/*												--params or hfo_params		*/
+	/*		--validate-model						generated vs hand written	*/
+	/*												ensembles, exit code 1 on	*/
+	/*												mismatch					*/
+	/*		--adaptive=atol							adaptive exponential steps,	*/
+	/*												output on the grid of dt	*/
+	/*		--seed=S								seed of the noise streams,	*/
+	/*												also of every validation	*/
+	/*		--params=<file>							model parameters, see		*/
+	/*												Parameters.h				*/
+	/*		--trace=<file>							stream V_C, V_H, Y_H to file*/
+	/*		--detect								online HFO detection on V_H	*/
+	/*		--load=<file>							continue from a snapshot	*/
+	/*		--fork=R								new noise realization R		*/
+	/*		--save=<file>							snapshot at the end			*/
+	Sigmoid_Mode mode		= SIGMOID_LIBM;
+	bool		 validate	= false;
+	int			 precision	= -1;
+	int			 equivalence= 0;
+	int			 exponential= 0;
+	int			 steps		= 1;
+	double		 adaptive	= 0.0;
+	double		 tolerance	= 0.0;
+	bool		 model		= false;
+	uint64_t	 seed		= rand();
+	std::string	 trace;
+	bool		 detect		= false;
+	std::string	 load, save;
+	std::string	 params;
+	int			 fork		= -1;
+	for (int i=1; i<argc; ++i) {
+		if (!strncmp(argv[i], "--sigmoid=", 10)) {
+			for (int m=SIGMOID_LIBM; m<=SIGMOID_AUTO; ++m) {
+				if (!strcmp(argv[i]+10, sigmoid_mode_name((Sigmoid_Mode) m))) {
+					mode = (Sigmoid_Mode) m;
+				}
+			}
+		} else if (!strcmp(argv[i], "--validate-sigmoid")) {
+			validate = true;
+		} else if (!strncmp(argv[i], "--validate-precision=", 21)) {
+			for (int p=PRECISION_DOUBLE; p<=PRECISION_MIXED; ++p) {
+				if (!strcmp(argv[i]+21, precision_name((Precision) p))) {
+					precision = p;
+				}
+			}
+		} else if (!strncmp(argv[i], "--validate-equivalence=", 23)) {
+			equivalence = std::atoi(argv[i]+23);
+		} else if (!strncmp(argv[i], "--validate-exponential=", 23)) {
+			exponential = std::atoi(argv[i]+23);
+		} else if (!strncmp(argv[i], "--exponential=", 14)) {
+			steps = std::atoi(argv[i]+14);
+		} else if (!strncmp(argv[i], "--validate-adaptive=", 20)) {
+			tolerance = std::atof(argv[i]+20);
+		} else if (!strcmp(argv[i], "--validate-model")) {
+			model = true;
+		} else if (!strncmp(argv[i], "--adaptive=", 11)) {
+			adaptive = std::atof(argv[i]+11);
+		} else if (!strncmp(argv[i], "--seed=", 7)) {
+			seed = std::strtoull(argv[i]+7, nullptr, 10);
+		} else if (!strncmp(argv[i], "--params=", 9)) {
+			params = argv[i]+9;
+		} else if (!strncmp(argv[i], "--trace=", 8)) {
+			trace = argv[i]+8;
+		} else if (!strcmp(argv[i], "--detect")) {
+			detect = true;
+		} else if (!strncmp(argv[i], "--load=", 7)) {
+			load = argv[i]+7;
+		} else if (!strncmp(argv[i], "--fork=", 7)) {
+			fork = std::atoi(argv[i]+7);
+		} else if (!strncmp(argv[i], "--save=", 7)) {
+			save = argv[i]+7;
+		}
+	}
+
+	if (validate) {
+		validate_sigmoid(mode == SIGMOID_LIBM ? SIGMOID_AUTO : mode, T, 16, seed);
+		return 0;
+	}
+	if (precision >= 0) {
+		set_sigmoid_mode(mode);
+		validate_precision((Precision) precision, T, 16, seed);
+		return 0;
+	}
+	/* The integrators are validated at --params, by default at parameters that produce HFOs */
+	auto validation_params = [&params]() {
+		const Parameter_Set P = params.empty() ? hfo_params() : read_params(params);
+		check_params(P);
+		return P;
+	};
+	if (equivalence > 0) {
+		return validate_equivalence(T, equivalence, seed, validation_params()) ? 0 : 1;
+	}
+	if (exponential > 0) {
+		set_sigmoid_mode(mode);
+		validate_exponential(exponential, T, 16, seed, validation_params());
+		return 0;
+	}
+	if (tolerance > 0) {
+		set_sigmoid_mode(mode);
+		validate_adaptive(tolerance, T, 16, seed, validation_params());
+		return 0;
+	}
+	if (model) {
+		set_sigmoid_mode(mode);
+		return validate_model(T, 16, seed) ? 0 : 1;
+	}
+	std::cout << "sigmoid kernel: " << sigmoid_mode_name(set_sigmoid_mode(mode)) << "\n";
+
 	/* Initialize the populations */
-	Cortical_Column C;
-	CA3_Column H;
+	Cortical_Column C(seed);
+	CA3_Column H(seed);
+
+	/* Model parameters, a snapshot restores input and connectivities on top of them */
+	if (!params.empty()) {
+		const Parameter_Set P = read_params(params);
+		check_params(P);
+		apply_params(P, C, H);
+	}
+
+	/* Resume from a snapshot, optionally with fresh noise from the same state */
+	if (!load.empty()) {
+		load_state(load, C, H);
+		if (fork >= 0) {
+			C.set_RNG(seed, fork);
+			H.set_RNG(seed, fork);
+		}
+	}
+
+	/* The exponential integrator takes steps of k*dt, SRK4 is used by default. Invalid k throw */
+	if (steps != 1) {
+		C.set_exponential(steps);
+		H.set_exponential(steps);
+	}
+
+	/* Optional streaming of the traces, memory use is independent of T */
+	std::unique_ptr<Trace_Writer> W;
+	if (!trace.empty()) {
+		Trace_Header header;
+		header.channels = {"V_C", "V_H", "Y_H"};
+		header.dt		= steps*dt;
+		header.seed		= seed;
+		header.params	= {{"T", T}, {"res", res}};
+		W.reset(new Trace_Writer(trace, header));
+	}
+
+	/* Optional detection of HFO events, the pass band has to lie below the Nyquist frequency */
+	std::unique_ptr<HFO_Detector> D;
+	if (detect) {
+		D.reset(new HFO_Detector(steps*dt));
+	}
 
 	/* Take the time of the simulation */
 	timer start,end;
 
+	/* Hardware counters around the integration loop, only with -DNM_PROFILE */
+	Perf_Counters perf;
+
 	/* Simulation */
 	start = std::chrono::high_resolution_clock::now();
-	for (int t=0; t< T*res; ++t) {
-		ODE (C, H);
+	perf.start();
+	if (adaptive > 0) {
+		Adaptive_Integrator A(C, H, adaptive);
+		A.run(T*res, 1, [&](const double* frame) {
+			if (W) {
+				W->push(frame);
+			}
+			if (D) {
+				D->push(frame[1]);
+			}
+		});
+		std::cout << A.accepted() << " accepted and " << A.rejected() << " rejected steps\n";
+	} else {
+		for (int t=0; t< T*res/steps; ++t) {
+			if (steps > 1) {
+				ODE_exponential(C, H);
+			} else {
+				ODE (C, H);
+			}
+			if (W) {
+				get_data(*W, C, H);
+			}
+			if (D) {
+				get_data(*D, H);
+			}
+		}
+	}
+	perf.stop();
+	if (W) {
+		W->close();
+	}
+	if (!save.empty()) {
+		save_state(save, C, H);
 	}
 	end = std::chrono::high_resolution_clock::now();
 
@@ -69,6 +268,15 @@ int main(void) {
 	double dif = 1E-3*std::chrono::duration_cast<std::chrono::milliseconds>( end - start ).count();
 	std::cout << "simulation done!\n";
 	std::cout << "took " << dif 	<< " seconds" << "\n";
+	if (D) {
+		std::cout << D->events.size() << " HFO events\n";
+		for (const HFO_Event& e : D->events) {
+			std::cout << "  onset " << e.onset << " ms, duration " << e.duration << " ms, "
+					  << e.frequency << " Hz, amplitude " << e.amplitude << "\n";
+		}
+	}
+	profile_report(std::cout);
+	perf.report(std::cout);
 	std::cout << "end\n";
 }
 /****************************************************************************************************/
@@ -0,0 +1,165 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Implementation of the HFO detector								*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "HFO_Detector.h"
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+/* Checks the sampling interval and the pass band before the window is allocated, returns dt */
+static double checked_dt(double dt, const HFO_Settings& settings) {
+	if (!(dt > 0)) {
+		throw std::invalid_argument("HFO_Detector: dt has to be positive");
+	}
+	if (!(settings.f_low > 0 && settings.f_low < settings.f_high && settings.f_high < 0.5E3/dt)) {
+		throw std::invalid_argument("HFO_Detector: the pass band has to satisfy 0 < f_low < f_high < fs/2");
+	}
+	if (!(settings.rms_window > 0 && settings.baseline_tau > 0)) {
+		throw std::invalid_argument("HFO_Detector: rms_window and baseline_tau have to be positive");
+	}
+	return dt;
+}
+
+HFO_Detector::HFO_Detector(double dt, const HFO_Settings& settings)
+: dt		(checked_dt(dt, settings)),
+  settings	(settings),
+  window	(std::max(1, (int) std::lround(settings.rms_window/dt)), 0.0),
+  alpha		(dt/settings.baseline_tau) {
+	/* Quality factors of the two sections of a fourth order Butterworth filter */
+	const double Q[2] = {0.54119610014619698, 1.3065629648763766};
+	const double fs   = 1E3/dt;
+	filter[0] = highpass(settings.f_low,  fs, Q[0]);
+	filter[1] = highpass(settings.f_low,  fs, Q[1]);
+	filter[2] = lowpass (settings.f_high, fs, Q[0]);
+	filter[3] = lowpass (settings.f_high, fs, Q[1]);
+}
+
+/* Coefficients after R. Bristow-Johnson, Cookbook formulae for audio EQ biquad filters */
+HFO_Detector::Biquad HFO_Detector::lowpass(double f, double fs, double Q) {
+	const double w = 2*M_PI*f/fs, c = std::cos(w), a = std::sin(w)/(2*Q), a0 = 1 + a;
+	Biquad B;
+	B.b0 = (1 - c)/2/a0;
+	B.b1 = (1 - c)/a0;
+	B.b2 = (1 - c)/2/a0;
+	B.a1 = -2*c/a0;
+	B.a2 = (1 - a)/a0;
+	return B;
+}
+
+HFO_Detector::Biquad HFO_Detector::highpass(double f, double fs, double Q) {
+	const double w = 2*M_PI*f/fs, c = std::cos(w), a = std::sin(w)/(2*Q), a0 = 1 + a;
+	Biquad B;
+	B.b0 =  (1 + c)/2/a0;
+	B.b1 = -(1 + c)/a0;
+	B.b2 =  (1 + c)/2/a0;
+	B.a1 = -2*c/a0;
+	B.a2 = (1 - a)/a0;
+	return B;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Detection 												*/
+/****************************************************************************************************/
+bool HFO_Detector::push(double x) {
+	/* Band pass */
+	double y = x;
+	for (int i=0; i<4; ++i) {
+		y = filter[i](y);
+	}
+
+	/* Sliding RMS */
+	const int W = window.size();
+	sq_sum += y*y - window[pos];
+	window[pos] = y*y;
+	pos = pos+1 == W ? 0 : pos+1;
+	const double rms = std::sqrt(std::max(0.0, sq_sum/W));
+	++n;
+
+	/* Baseline, a running average until it spans baseline_tau, frozen during events */
+	if (!active) {
+		const double a = std::max(alpha, 1.0/n);
+		const double d = rms - rms_mean;
+		rms_mean += a*d;
+		rms_var	 += a*(d*d - rms_var);
+		sig_var	 += a*(y*y - sig_var);
+	}
+	const double threshold = rms_mean + settings.threshold_sd*std::sqrt(rms_var);
+
+	bool done = false;
+	if (!active && rms > threshold && n*dt >= settings.warmup) {
+		active			= true;
+		event			= HFO_Event();
+		event.onset		= (n-1)*dt;
+		peak_threshold	= settings.peak_sd*std::sqrt(sig_var);
+		rising			= false;
+	}
+	if (active) {
+		event.amplitude = std::max(event.amplitude, std::fabs(y));
+
+		/* Local maxima of the filtered signal above the peak threshold */
+		if (rising && y < last_y && last_y > peak_threshold) {
+			last_peak = n-1;
+			if (event.cycles++ == 0) {
+				first_peak = last_peak;
+			}
+		}
+		rising = y > last_y;
+
+		if (rms <= threshold) {
+			done = finish();
+		}
+	}
+	last_y = y;
+	return done;
+}
+
+bool HFO_Detector::finish(void) {
+	active			= false;
+	event.duration	= n*dt - event.onset;
+	if (event.duration < settings.min_duration || event.cycles < settings.min_cycles) {
+		return false;
+	}
+	/* Mean period between the first and the last peak */
+	event.frequency = 1E3*(event.cycles - 1)/((last_peak - first_peak)*dt);
+	events.push_back(event);
+	return true;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
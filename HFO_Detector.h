@@ -0,0 +1,131 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Online HFO detection										*/
+/*																									*/
+/*		Streaming detector in the spirit of Staba et al., J Neurophysiol 88:1743 (2002). The		*/
+/*		signal is band-pass filtered by a cascade of biquads, its RMS is tracked over a short		*/
+/*		sliding window and an event is detected while the RMS exceeds the baseline mean by			*/
+/*		threshold_sd standard deviations. An event is kept if it lasts at least min_duration		*/
+/*		and contains at least min_cycles peaks above peak_sd standard deviations of the filtered	*/
+/*		signal. The baseline statistics are exponential averages that are frozen during events.	*/
+/*		The cost per sample is a handful of multiply-adds, independent of the history.				*/
+/****************************************************************************************************/
+#pragma once
+#include <vector>
+using std::vector;
+
+/****************************************************************************************************/
+/*										Settings and events											*/
+/****************************************************************************************************/
+struct HFO_Settings {
+	double	f_low			= 80;		/* Lower edge of the pass band in Hz					*/
+	double	f_high			= 500;		/* Upper edge of the pass band in Hz					*/
+	double	rms_window		= 3;		/* Length of the RMS window in ms						*/
+	double	threshold_sd	= 5;		/* RMS threshold in standard deviations of the RMS		*/
+	double	peak_sd			= 3;		/* Peak threshold in standard deviations of the signal	*/
+	double	min_duration	= 6;		/* Minimal duration of an event in ms					*/
+	int		min_cycles		= 6;		/* Minimal number of peaks of an event					*/
+	double	baseline_tau	= 5000;		/* Time constant of the baseline statistics in ms		*/
+	double	warmup			= 1000;		/* Time before the first detection in ms				*/
+};
+
+struct HFO_Event {
+	double	onset		= 0.0;			/* Start in ms after the first sample					*/
+	double	duration	= 0.0;			/* Duration in ms										*/
+	double	frequency	= 0.0;			/* Mean oscillation frequency in Hz						*/
+	double	amplitude	= 0.0;			/* Maximal absolute value of the filtered signal		*/
+	int		cycles		= 0;			/* Number of peaks above the peak threshold				*/
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Implementation of the detector									*/
+/****************************************************************************************************/
+class HFO_Detector {
+public:
+	/* Constructors, dt is the sampling interval in ms. Throws std::invalid_argument unless		*/
+	/* 0 < f_low < f_high < fs/2 and dt, rms_window and baseline_tau are positive				*/
+	HFO_Detector(double dt, const HFO_Settings& settings = HFO_Settings());
+
+	/* Add one sample, returns true if an event was completed with this sample */
+	bool	push	(double x);
+
+	/* Detected events, can be cleared by the caller at any time */
+	vector<HFO_Event>	events;
+
+private:
+	/* Second order section in transposed direct form II */
+	struct Biquad {
+		double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+		double z1 = 0, z2 = 0;
+		double	operator() (double x) {
+			const double y = b0*x + z1;
+			z1 = b1*x - a1*y + z2;
+			z2 = b2*x - a2*y;
+			return y;
+		}
+	};
+	static Biquad	lowpass		(double f, double fs, double Q);
+	static Biquad	highpass	(double f, double fs, double Q);
+
+	/* Close the current event */
+	bool	finish	(void);
+
+	const double		dt;
+	const HFO_Settings	settings;
+
+	/* Fourth order Butterworth high- and lowpass */
+	Biquad				filter[4];
+
+	/* Squared filtered samples of the RMS window */
+	vector<double>		window;
+	int					pos		= 0;
+	double				sq_sum	= 0.0;
+
+	/* Baseline statistics of the RMS and the filtered signal */
+	double				alpha;
+	double				rms_mean = 0.0, rms_var = 0.0, sig_var = 0.0;
+
+	/* State of the current event */
+	long long			n		= 0;
+	bool				active	= false;
+	HFO_Event			event;
+	double				last_y	= 0.0;
+	bool				rising	= false;
+	double				peak_threshold = 0.0;
+	long long			first_peak = 0, last_peak = 0;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,437 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*		Benchmarks of the kernels and of the end-to-end throughput									*/
+/*																									*/
+/*		usage: HFO_bench [--format=csv|json] [--out=file] [--quick]									*/
+/*		Kernels are reported in ns per call or per value, the throughput in simulated seconds		*/
+/*		per wall-clock second summed over all realizations. Every value is the median of five		*/
+/*		repetitions, each repetition runs for at least the minimal time.							*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Data_Storage.h"
+#include "Models.h"
+#include "Network.h"
+#include "ODE.h"
+#include "Welch.h"
+using std::vector;
+
+/****************************************************************************************************/
+/*										Fixed simulation settings									*/
+/****************************************************************************************************/
+extern const int res 	= 1E4;								/* number of iteration steps per s		*/
+extern const double dt 	= 1E3/res;							/* duration of a timestep in ms			*/
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Measurement and results										*/
+/****************************************************************************************************/
+struct Bench_Result {
+	std::string	group;
+	std::string	name;
+	std::string	parameter;
+	double		value;
+	std::string	unit;
+};
+
+static double min_time = 0.2;								/* minimal time of a repetition in s	*/
+
+/* Median time in ns of a single call of body(n) that does n units of work, n is doubled until	*/
+/* a repetition takes at least min_time														*/
+static double measure(const std::function<void(long)>& body) {
+	typedef std::chrono::steady_clock clock;
+	long n = 1;
+	for (;;) {
+		const clock::time_point start = clock::now();
+		body(n);
+		const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+		if (elapsed >= min_time || n >= (1L << 40)) {
+			break;
+		}
+		n = elapsed > 0 ? std::max(2*n, (long) (n * 1.2 * min_time/elapsed)) : 2*n;
+	}
+	vector<double> times;
+	for (int rep=0; rep<5; ++rep) {
+		const clock::time_point start = clock::now();
+		body(n);
+		times.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count()/n);
+	}
+	std::sort(times.begin(), times.end());
+	return times[2];
+}
+
+/* Keeps the compiler from removing unused results */
+static volatile double sink;
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Kernels		 											*/
+/****************************************************************************************************/
+static void bench_sigmoid(vector<Bench_Result>& out) {
+	const int M = 4096;
+	vector<double> u(M), Q(M);
+	vector<float>  uf(M), Qf(M);
+	for (int i=0; i<M; ++i) {
+		u[i]  = -10.0 + 20.0*i/M;
+		uf[i] = u[i];
+	}
+	for (int m=SIGMOID_LIBM; m<=SIGMOID_AVX512; ++m) {
+		const Sigmoid_Mode used = set_sigmoid_mode((Sigmoid_Mode) m);
+		if (used != m) {
+			continue;
+		}
+		const double ns = measure([&](long n) {
+			for (long k=0; k<n; k+=M) {
+				sigmoid(1.0, &u[0], &Q[0], M);
+			}
+			sink = Q[M/2];
+		});
+		out.push_back({"kernel", "sigmoid", sigmoid_mode_name(used), ns, "ns/value"});
+
+		const double ns_f = measure([&](long n) {
+			for (long k=0; k<n; k+=M) {
+				sigmoid(1.0f, &uf[0], &Qf[0], M);
+			}
+			sink = Qf[M/2];
+		});
+		out.push_back({"kernel", "sigmoid float", sigmoid_mode_name(used), ns_f, "ns/value"});
+	}
+	set_sigmoid_mode(SIGMOID_LIBM);
+}
+
+static void bench_stages(vector<Bench_Result>& out) {
+	Cortical_Column C(1);
+	CA3_Column		H(1);
+	for (int N=0; N<4; ++N) {
+		const std::string stage = std::to_string(N);
+		out.push_back({"kernel", "Cortical_Column::set_RK", stage, measure([&](long n) {
+			for (long k=0; k<n; ++k) {
+				C.set_RK(N);
+			}
+		}), "ns/call"});
+		out.push_back({"kernel", "CA3_Column::get_RK", stage, measure([&](long n) {
+			for (long k=0; k<n; ++k) {
+				H.get_RK(N);
+			}
+		}), "ns/call"});
+	}
+
+	/* add_RK is timed together with the stages that keep the state bounded */
+	const double c_step = measure([&](long n) {
+		for (long k=0; k<n; ++k) {
+			for (int N=0; N<4; ++N) {
+				C.set_RK(N);
+			}
+			C.add_RK();
+		}
+	});
+	const double h_step = measure([&](long n) {
+		for (long k=0; k<n; ++k) {
+			for (int N=0; N<4; ++N) {
+				H.get_RK(N);
+			}
+			H.add_RK();
+		}
+	});
+	double c_stages = 0.0, h_stages = 0.0;
+	for (const Bench_Result& r : out) {
+		c_stages += r.name == "Cortical_Column::set_RK" ? r.value : 0.0;
+		h_stages += r.name == "CA3_Column::get_RK"		? r.value : 0.0;
+	}
+	out.push_back({"kernel", "Cortical_Column::add_RK", "", std::max(0.0, c_step - c_stages), "ns/call"});
+	out.push_back({"kernel", "CA3_Column::add_RK",		"", std::max(0.0, h_step - h_stages), "ns/call"});
+
+	/* Fused steps against the separate stages and add_RK */
+	const double c_fused = measure([&](long n) {
+		for (long k=0; k<n; ++k) {
+			C.step();
+		}
+	});
+	const double h_fused = measure([&](long n) {
+		for (long k=0; k<n; ++k) {
+			H.step();
+		}
+	});
+	out.push_back({"kernel", "Cortical_Column::step", "staged",	c_step,				"ns/step"});
+	out.push_back({"kernel", "Cortical_Column::step", "fused",	c_fused,			"ns/step"});
+	out.push_back({"kernel", "Cortical_Column::step", "speedup",	c_step / c_fused,	"x"});
+	out.push_back({"kernel", "CA3_Column::step",	  "staged",	h_step,				"ns/step"});
+	out.push_back({"kernel", "CA3_Column::step",	  "fused",	h_fused,			"ns/step"});
+	out.push_back({"kernel", "CA3_Column::step",	  "speedup",	h_step / h_fused,	"x"});
+	out.push_back({"kernel", "ODE", "column pair", measure([&](long n) {
+		for (long k=0; k<n; ++k) {
+			ODE(C, H);
+		}
+	}), "ns/step"});
+}
+
+static void bench_rng(vector<Bench_Result>& out) {
+	random_stream_philox stream(0.0, 1.0, 1, 0, RNG_CORTEX, 0);
+	out.push_back({"kernel", "random_stream_philox", "operator()", measure([&](long n) {
+		double s = 0.0;
+		for (long k=0; k<n; ++k) {
+			s += stream();
+		}
+		sink = s;
+	}), "ns/draw"});
+
+	const int M = 1024;
+	vector<double> z(M);
+	out.push_back({"kernel", "random_stream_philox", "fill", measure([&](long n) {
+		for (long k=0; k<n; k+=M) {
+			stream.fill(&z[0], M);
+		}
+		sink = z[0];
+	}), "ns/draw"});
+}
+
+static void bench_recording(vector<Bench_Result>& out) {
+	Cortical_Column C(1);
+	CA3_Column		H(1);
+	double frame[3] = {0.1, -65.0, 2.0};
+
+	Decimator D(10);
+	out.push_back({"recording", "Decimator", "factor 10", measure([&](long n) {
+		double y = 0.0;
+		for (long k=0; k<n; ++k) {
+			D.push(frame[0] + k*1E-9, y);
+		}
+		sink = y;
+	}), "ns/sample"});
+
+	HFO_Detector detector(dt);
+	out.push_back({"recording", "HFO_Detector", "", measure([&](long n) {
+		for (long k=0; k<n; ++k) {
+			detector.push(frame[1] + (k & 7)*1E-3);
+		}
+	}), "ns/sample"});
+
+	Welch_PSD spectrum(4096, res);
+	out.push_back({"recording", "Welch_PSD", "window 4096", measure([&](long n) {
+		for (long k=0; k<n; ++k) {
+			spectrum.push(frame[2] + (k & 15)*1E-3);
+		}
+	}), "ns/sample"});
+
+	/* The trace writer stores to a scratch file that is removed afterwards */
+	const std::string file = "HFO_bench.trace";
+	{
+		Trace_Header header;
+		header.channels = {"V_C", "V_H", "Y_H"};
+		header.dt		= dt;
+		Trace_Writer W(file, header);
+		out.push_back({"recording", "Trace_Writer", "3 channels", measure([&](long n) {
+			for (long k=0; k<n; ++k) {
+				get_data(W, C, H);
+			}
+		}), "ns/frame"});
+		W.close();
+	}
+	std::remove(file.c_str());
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 End-to-end throughput										*/
+/****************************************************************************************************/
+static void bench_throughput(vector<Bench_Result>& out, const vector<int>& sizes, const vector<int>& threads) {
+	for (int R : sizes) {
+		const std::string size = "R=" + std::to_string(R);
+
+		/* Independent column pairs */
+		vector<Cortical_Column> C;
+		vector<CA3_Column>		H;
+		for (int r=0; r<R; ++r) {
+			C.push_back(Cortical_Column(1, r));
+			H.push_back(CA3_Column(1, r));
+		}
+		double ns = measure([&](long n) {
+			for (long k=0; k<n; ++k) {
+				for (int r=0; r<R; ++r) {
+					ODE(C[r], H[r]);
+				}
+			}
+		});
+		out.push_back({"throughput", "columns", size, 1E9/ns*R/res, "sim-s/s"});
+
+		/* Ensembles, all realizations per stage in one pass */
+		Cortical_Ensemble	CE(R, 1);
+		CA3_Ensemble		HE(R, 1);
+		ns = measure([&](long n) {
+			for (long k=0; k<n; ++k) {
+				ODE(CE, HE);
+			}
+		});
+		out.push_back({"throughput", "ensemble", size, 1E9/ns*R/res, "sim-s/s"});
+
+		/* Ensembles generated from the model descriptions */
+		Cortical_Model_Ensemble	CG(R, 1);
+		CA3_Model_Ensemble		HG(R, 1);
+		ns = measure([&](long n) {
+			for (long k=0; k<n; ++k) {
+				ODE(CG, HG);
+			}
+		});
+		out.push_back({"throughput", "model ensemble", size, 1E9/ns*R/res, "sim-s/s"});
+
+		/* Ensembles in single and mixed precision */
+		Cortical_Ensemble_Float	CF(R, 1);
+		CA3_Ensemble_Float		HF(R, 1);
+		ns = measure([&](long n) {
+			for (long k=0; k<n; ++k) {
+				ODE(CF, HF);
+			}
+		});
+		out.push_back({"throughput", "ensemble float", size, 1E9/ns*R/res, "sim-s/s"});
+
+		Cortical_Ensemble_Mixed	CM(R, 1);
+		CA3_Ensemble_Mixed		HM(R, 1);
+		ns = measure([&](long n) {
+			for (long k=0; k<n; ++k) {
+				ODE(CM, HM);
+			}
+		});
+		out.push_back({"throughput", "ensemble mixed", size, 1E9/ns*R/res, "sim-s/s"});
+
+		/* Uncoupled network on several threads, R cortical and R CA3 columns */
+		for (int T : threads) {
+			Network net(R, R, {}, 1);
+			ns = measure([&](long n) {
+				net.run(n, T);
+			});
+			out.push_back({"throughput", "network threads=" + std::to_string(T), size, 1E9/ns*R/res, "sim-s/s"});
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Output		 											*/
+/****************************************************************************************************/
+static void write_csv(std::ostream& out, const vector<Bench_Result>& results) {
+	out << "group,name,parameter,value,unit\n";
+	for (const Bench_Result& r : results) {
+		out << r.group << "," << r.name << "," << r.parameter << "," << r.value << "," << r.unit << "\n";
+	}
+}
+
+static void write_json(std::ostream& out, const vector<Bench_Result>& results) {
+	out << "{\n  \"threads\": " << std::thread::hardware_concurrency()
+		<< ",\n  \"dt_ms\": " << dt << ",\n  \"results\": [\n";
+	for (unsigned i=0; i<results.size(); ++i) {
+		const Bench_Result& r = results[i];
+		out << "    {\"group\": \"" << r.group << "\", \"name\": \"" << r.name
+			<< "\", \"parameter\": \"" << r.parameter << "\", \"value\": " << r.value
+			<< ", \"unit\": \"" << r.unit << "\"}" << (i+1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Main benchmark routine										*/
+/****************************************************************************************************/
+int main(int argc, char* argv[]) {
+	std::string format = "csv";
+	std::string file;
+	bool		quick  = false;
+	for (int i=1; i<argc; ++i) {
+		if		(!strncmp(argv[i], "--format=", 9))	{format = argv[i]+9;}
+		else if (!strncmp(argv[i], "--out=", 6))	{file	= argv[i]+6;}
+		else if (!strcmp (argv[i], "--quick"))		{quick	= true;}
+		else {
+			std::cerr << "usage: " << argv[0] << " [--format=csv|json] [--out=file] [--quick]\n";
+			return 1;
+		}
+	}
+	if (quick) {
+		min_time = 0.02;
+	}
+
+	/* Thread counts up to the number of cores */
+	const int	cores = std::max(1u, std::thread::hardware_concurrency());
+	vector<int>	threads;
+	for (int T=1; T<cores; T*=2) {
+		threads.push_back(T);
+	}
+	threads.push_back(cores);
+
+	vector<Bench_Result> results;
+	bench_sigmoid	(results);
+	bench_stages	(results);
+	bench_rng		(results);
+	bench_recording	(results);
+	bench_throughput(results, quick ? vector<int>{1, 64} : vector<int>{1, 16, 256, 1024}, threads);
+
+	std::ofstream	stream;
+	if (!file.empty()) {
+		stream.open(file);
+		if (!stream) {
+			std::cerr << "error: cannot create " << file << "\n";
+			return 1;
+		}
+	}
+	std::ostream&	out = file.empty() ? std::cout : stream;
+	out.precision(6);
+	if (format == "json") {
+		write_json(out, results);
+	} else {
+		write_csv(out, results);
+	}
+	return 0;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,54 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+TARGET = HFO_bench
+
+SOURCES +=  Adaptive_Integrator.cpp \
+	    CA3_Column.cpp	\
+	    CA3_Ensemble.cpp	\
+	    Cortical_Column.cpp \
+	    Cortical_Ensemble.cpp \
+	    Decimator.cpp	\
+	    HFO_bench.cpp	\
+	    HFO_Detector.cpp	\
+	    Models.cpp		\
+	    Network.cpp		\
+	    Parameters.cpp	\
+	    Profiler.cpp	\
+	    PSP_Propagator.cpp	\
+	    Random_Stream.cpp	\
+	    Sigmoid.cpp		\
+	    Trace_Writer.cpp	\
+	    Welch.cpp
+
+HEADERS +=  Adaptive_Integrator.h \
+	    CA3_Column.h	\
+	    CA3_Ensemble.h	\
+	    Cortical_Column.h	\
+	    Cortical_Ensemble.h	\
+	    Data_Storage.h	\
+	    Decimator.h		\
+	    HFO_Detector.h	\
+	    Model.h		\
+	    Model_Ensemble.h	\
+	    Models.h		\
+	    Network.h		\
+	    ODE.h		\
+	    Parameters.h	\
+	    Profiler.h		\
+	    PSP_Propagator.h	\
+	    Random_Stream.h	\
+	    Sigmoid.h		\
+	    SRK_Moments.h	\
+	    Trace_Format.h	\
+	    Trace_Writer.h	\
+	    Welch.h
+    
+
+QMAKE_CXXFLAGS += -std=c++11 -O3 -pthread
+LIBS += -pthread
+
+# Instrumentation of the hot paths, see Profiler.h
+# DEFINES += NM_PROFILE
@@ -31,12 +31,24 @@
 /* 		Implementation of the simulation as MATLAB routine (mex compiler)							*/
 /* 		mex command is given by:																	*/
 /* 		mex CXXFLAGS="\$CXXFLAGS -std=c++11 -O3" HFO_mex.cpp CA3_Column.cpp Cortical_Column.cpp     */
+/* 			CA3_Ensemble.cpp Cortical_Ensemble.cpp Decimator.cpp PSP_Propagator.cpp Random_Stream.cpp	*/
+/* 			Sigmoid.cpp Burn_In.cpp Parameters.cpp													*/
+/*																									*/
+/*		Param_C and Param_H are structs of parameters of the cortex and CA3, e.g.					*/
+/*		struct('N_pp', 150), or the name of a parameter file, see Parameters.h. Any other value		*/
+/*		keeps the defaults.																			*/
 /****************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include "mex.h"
 #include "matrix.h"
+#include "Burn_In.h"
 #include "Data_Storage.h"
 #include "ODE.h"
+#include "Parameters.h"
 mxArray* SetMexArray(int N, int M);
+void	 GetMexParams(const mxArray* Param, const char* prefix, Parameter_Set& params);
 
 /****************************************************************************************************/
 /*										Fixed simulation settings									*/
@@ -61,31 +73,73 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 	/* Fetch inputs */
 	const int T				= (int) (mxGetScalar(prhs[0]));	/* Duration of simulation in s			*/
 	const int Time 			= (T+onset)*res;				/* Total number of iteration steps		*/
-	double* Param_C         = mxGetPr (prhs[1]);			/* Parameters of C module				*/
-	double* Param_H         = mxGetPr (prhs[2]);			/* Parameters of H module				*/
+	double* Rates			= nrhs > 3 ? mxGetPr(prhs[3]) : NULL;	/* Output rates in Hz, optional	*/
+
+	/* Decimation factor of every channel, every rate has to divide res */
+	int factor[3] = {1, 1, 1};
+	for (int i=0; Rates && i<3 && i<(int) mxGetNumberOfElements(prhs[3]); ++i) {
+		if (!std::isfinite(Rates[i]) || Rates[i] <= 0 || Rates[i] > res) {
+			mexErrMsgTxt("output rates have to be positive and at most res");
+		}
+		const double f = res/Rates[i];
+		if (std::abs(f - std::round(f)) > 1E-9*f) {
+			mexErrMsgTxt("output rates have to divide res");
+		}
+		factor[i] = (int) std::lround(f);
+	}
+
+	/* Parameters of the C and H module */
+	Parameter_Set params;
+	GetMexParams(prhs[1], "C.", params);
+	GetMexParams(prhs[2], "H.", params);
+	try {
+		check_params(params);
+	} catch (const std::invalid_argument& e) {
+		mexErrMsgTxt(e.what());
+	}
 
 	/* Initialize the populations */
-	C_Column Cortex;
-	H_Column HFO;
+	Cortical_Column Cortex;
+	CA3_Column		HFO;
+	apply_params(params, Cortex, HFO);
 
 	/* Create data containers */
-	mxArray* V_C		= SetMexArray(1, T*res);
-	mxArray* V_H		= SetMexArray(1, T*res);
-	mxArray* Y_H		= SetMexArray(1, T*res);
+	mxArray* V_C		= SetMexArray(1, T*res/factor[0]);
+	mxArray* V_H		= SetMexArray(1, T*res/factor[1]);
+	mxArray* Y_H		= SetMexArray(1, T*res/factor[2]);
 
-	/* Pointer to the actual data block */
-	double* Pr_V_C	= mxGetPr(V_C);
-	double* Pr_V_H	= mxGetPr(V_H);
-	double* Pr_Y_H	= mxGetPr(Y_H);
+	/* Recorders writing to the actual data blocks */
+	Channel_Recorder Recorder[3] = {Channel_Recorder(mxGetPr(V_C), T*res/factor[0], factor[0]),
+									Channel_Recorder(mxGetPr(V_H), T*res/factor[1], factor[1]),
+									Channel_Recorder(mxGetPr(Y_H), T*res/factor[2], factor[2])};
+
+	/* The filters need lag steps beyond the last recorded one */
+	int lag = 0;
+	for (int i=0; i<3; ++i) {
+		lag = std::max(lag, Recorder[i].lead());
+	}
+
+	/* Optional directory of burned in states, then the onset is skipped and the run continues	*/
+	/* from a cached state with its own noise realization. The filters are still fed their lead	*/
+	/* of lag steps before the first recorded one												*/
+	int first = 0;
+	if (nrhs > 4) {
+		char* directory = mxArrayToString(prhs[4]);
+		try {
+			Burn_In_Cache cache(directory);
+			cache.start(Cortex, HFO, params, onset, rand(), rand());
+		} catch (const std::runtime_error& e) {
+			mxFree(directory);
+			mexErrMsgTxt(e.what());
+		}
+		mxFree(directory);
+		first = std::max(0, onset*res - lag);
+	}
 
 	/* Simulation */
-	int count = 0;
-	for (int t=0; t<Time; ++t) {
+	for (int t=first; t<Time+lag; ++t) {
 		ODE (Cortex, HFO);
-		if(t>=onset*res){
-			get_data(count, Cortex, HFO, Pr_V_C, Pr_V_H, Pr_Y_H);
-			++count;
-		}
+		get_data(t-onset*res, Recorder, Cortex, HFO);
 	}
 
 	/* Output of the simulation */
@@ -112,3 +166,34 @@ mxArray* SetMexArray(int N, int M) {
 /****************************************************************************************************/
 /*										 		end													*/
 /****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Fetch parameters of a module									*/
+/****************************************************************************************************/
+/* Fields of a struct are parameters of the module, a string names a parameter file */
+void GetMexParams(const mxArray* Param, const char* prefix, Parameter_Set& params) {
+	if (mxIsStruct(Param)) {
+		for (int i=0; i<mxGetNumberOfFields(Param); ++i) {
+			const mxArray* value = mxGetFieldByNumber(Param, 0, i);
+			if (!value || !mxIsNumeric(value) || mxGetNumberOfElements(value) != 1) {
+				mexErrMsgTxt("parameters have to be numeric scalars");
+			}
+			params.push_back(std::make_pair(prefix + std::string(mxGetFieldNameByNumber(Param, i)),
+											mxGetScalar(value)));
+		}
+	} else if (mxIsChar(Param)) {
+		char* file = mxArrayToString(Param);
+		try {
+			const Parameter_Set P = read_params(file);
+			params.insert(params.end(), P.begin(), P.end());
+		} catch (const std::runtime_error& e) {
+			mxFree(file);
+			mexErrMsgTxt(e.what());
+		}
+		mxFree(file);
+	}
+}
+/****************************************************************************************************/
+/*										 		end													*/
+/****************************************************************************************************/
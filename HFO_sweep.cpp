@@ -0,0 +1,143 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*		Parameter sweep over a grid of parameters and noise realizations							*/
+/*																									*/
+/*		usage: HFO_sweep T R output.csv axis [axis ...] [--threads=N] [--seed=S] [--onset=S]		*/
+/*						 [--psd=spectra.csv] [--window=N] [--fmax=F] [--events=events.csv]			*/
+/*						 [--cache=dir] [--states=N] [--decorrelate=S] [--workers=N]					*/
+/*						 [--params=file]																*/
+/*		where every axis is of the form C.<param>=v1,v2,... or H.<param>=first:step:last			*/
+/****************************************************************************************************/
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "Shard.h"
+#include "Sweep.h"
+
+/****************************************************************************************************/
+/*										Fixed simulation settings									*/
+/****************************************************************************************************/
+typedef std::chrono::high_resolution_clock::time_point timer;
+extern const int res 	= 1E4;								/* number of iteration steps per s		*/
+extern const double dt 	= 1E3/res;							/* duration of a timestep in ms			*/
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Main sweep routine											*/
+/****************************************************************************************************/
+int main(int argc, char* argv[]) {
+	if (argc < 5) {
+		std::cerr << "usage: " << argv[0] << " T R output.csv axis [axis ...]"
+				  << " [--threads=N] [--seed=S] [--onset=S] [--psd=spectra.csv] [--window=N] [--fmax=F]"
+				  << " [--events=events.csv] [--cache=dir] [--states=N] [--decorrelate=S]"
+				  << " [--workers=N] [--params=file]\n"
+				  << "axis:  C.<param>=v1,v2,... or H.<param>=first:step:last\n";
+		return 1;
+	}
+
+	/* Fetch inputs */
+	const int	T			= atoi(argv[1]);				/* Duration of every job in s			*/
+	const int	R			= atoi(argv[2]);				/* Realizations per grid point			*/
+	const char*	file		= argv[3];						/* Output file							*/
+	int			threads		= 0;							/* Number of threads, 0 for all cores	*/
+	uint64_t	seed		= 0;							/* Global seed of the noise				*/
+	int			onset		= 10;							/* Time until data is evaluated in s	*/
+	std::string	psd;										/* Output file of the spectra			*/
+	int			window		= 4096;							/* Window of the spectra in steps		*/
+	double		f_max		= 400;							/* Highest stored frequency in Hz		*/
+	std::string	events;										/* Output file of the HFO events		*/
+	std::string	cache;										/* Directory of burned in states		*/
+	int			states		= 0;							/* Burned in states per grid point		*/
+	double		decorrelate	= 1.0;							/* Decorrelation after a cached start	*/
+	int			workers		= 0;							/* Worker processes, 0 for threads only	*/
+	std::string	params;										/* Parameters of every grid point		*/
+
+	try {
+		vector<Sweep_Axis> axes;
+		for (int i=4; i<argc; ++i) {
+			if		(!strncmp(argv[i], "--threads=", 10))	{threads	= atoi(argv[i]+10);}
+			else if (!strncmp(argv[i], "--seed=", 7))		{seed		= strtoull(argv[i]+7, nullptr, 10);}
+			else if (!strncmp(argv[i], "--onset=", 8))		{onset		= atoi(argv[i]+8);}
+			else if (!strncmp(argv[i], "--psd=", 6))		{psd		= argv[i]+6;}
+			else if (!strncmp(argv[i], "--window=", 9))		{window		= atoi(argv[i]+9);}
+			else if (!strncmp(argv[i], "--fmax=", 7))		{f_max		= atof(argv[i]+7);}
+			else if (!strncmp(argv[i], "--events=", 9))		{events		= argv[i]+9;}
+			else if (!strncmp(argv[i], "--cache=", 8))		{cache		= argv[i]+8;}
+			else if (!strncmp(argv[i], "--states=", 9))		{states		= atoi(argv[i]+9);}
+			else if (!strncmp(argv[i], "--decorrelate=", 14))	{decorrelate = atof(argv[i]+14);}
+			else if (!strncmp(argv[i], "--workers=", 10))	{workers	= atoi(argv[i]+10);}
+			else if (!strncmp(argv[i], "--params=", 9))		{params		= argv[i]+9;}
+			else 											{axes.push_back(Sweep::parse_axis(argv[i]));}
+		}
+		Sweep sweep(axes, R, seed);
+		if (!params.empty()) {
+			sweep.set_params(read_params(params));
+		}
+		if (!psd.empty()) {
+			sweep.set_spectrum(window, f_max);
+		}
+		sweep.set_detection(!events.empty());
+		if (!cache.empty() || states > 0) {
+			sweep.set_burn_in(cache, states > 0 ? states : 8, decorrelate);
+		}
+
+		/* Simulation */
+		timer start = std::chrono::high_resolution_clock::now();
+		vector<Sweep_Result> results = workers > 0 ? run_sharded(sweep, T, onset, workers)
+													: sweep.run(T, onset, threads);
+		timer end	= std::chrono::high_resolution_clock::now();
+		sweep.write(file, results);
+		if (!psd.empty()) {
+			sweep.write_spectra(psd, results);
+		}
+		if (!events.empty()) {
+			sweep.write_events(events, results);
+		}
+
+		/* Time consumed by the simulation */
+		double dif = 1E-3*std::chrono::duration_cast<std::chrono::milliseconds>( end - start ).count();
+		std::cout << sweep.jobs() << " jobs done!\n";
+		std::cout << "took " << dif 	<< " seconds" << "\n";
+	} catch (const std::exception& e) {
+		std::cerr << "error: " << e.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,58 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+TARGET = HFO_sweep
+
+SOURCES +=  Adaptive_Integrator.cpp \
+	    Burn_In.cpp	\
+	    CA3_Column.cpp	\
+	    CA3_Ensemble.cpp	\
+	    Cortical_Column.cpp \
+	    Cortical_Ensemble.cpp \
+	    HFO_Detector.cpp	\
+	    HFO_sweep.cpp	\
+	    Models.cpp		\
+	    Parameters.cpp	\
+	    Profiler.cpp	\
+	    PSP_Propagator.cpp	\
+	    Random_Stream.cpp	\
+	    Shard.cpp		\
+	    Sigmoid.cpp		\
+	    Sweep.cpp		\
+	    Welch.cpp
+
+HEADERS +=  Adaptive_Integrator.h \
+	    Burn_In.h	\
+	    CA3_Column.h	\
+	    CA3_Ensemble.h	\
+	    Cortical_Column.h	\
+	    Cortical_Ensemble.h	\
+	    Data_Storage.h	\
+	    Decimator.h		\
+	    HFO_Detector.h	\
+	    Model.h		\
+	    Model_Ensemble.h	\
+	    Models.h		\
+	    ODE.h		\
+	    Parameters.h	\
+	    Profiler.h		\
+	    PSP_Propagator.h	\
+	    Random_Stream.h	\
+	    Shard.h		\
+	    Sigmoid.h		\
+	    Snapshot.h		\
+	    SRK_Moments.h	\
+	    Sweep.h		\
+	    Thread_Pool.h	\
+	    Trace_Format.h	\
+	    Trace_Writer.h	\
+	    Welch.h
+    
+
+QMAKE_CXXFLAGS += -std=c++11 -O3 -pthread
+LIBS += -pthread
+
+# Instrumentation of the hot paths, see Profiler.h
+# DEFINES += NM_PROFILE
@@ -0,0 +1,109 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Compact description of a neural mass model							*/
+/*																									*/
+/*		A model is a struct of constexpr tables, from which Model_Ensemble generates the fused		*/
+/*		SRK4 stage kernels at compile time. Its equations, with sums in the order of the tables:	*/
+/*			u_i	= sum of weight * y_psp over the connections with target i							*/
+/*			Q_i	= Q_max / (1 + exp(-scale * (u_i - theta) / sigma))									*/
+/*			y'	= x,	x' = gamma * (G * (Q_source - y) - 2 * x)	for every PSP					*/
+/*			tau V' = -(g_L * (V - E_L) + sum of weight * y_psp * (V - E)) for every membrane,		*/
+/*				summed over its conductances														*/
+/*		Noisy PSPs receive gamma^2 times the two noise streams I_l and I_l0 in x as in the			*/
+/*		columns, the streams of the kth noisy PSP are 2k and 2k+1 of the RNG column. Output			*/
+/*		channel c is the sum of weight * y or weight * V over the outputs of channel c.				*/
+/*																									*/
+/*		A model M provides, each table being a static constexpr std::array that is defined once	*/
+/*		in a translation unit, see Models.cpp:														*/
+/*			column				RNG_Column of its noise streams										*/
+/*			channels			number of output channels											*/
+/*			populations			Model_Population													*/
+/*			psps				Model_PSP															*/
+/*			connections			Model_Connection													*/
+/*			membranes			Model_Membrane														*/
+/*			conductances		Model_Conductance													*/
+/*			outputs				Model_Output														*/
+/****************************************************************************************************/
+#pragma once
+#include <array>
+#include "Random_Stream.h"
+
+/****************************************************************************************************/
+/*										Elements of a model											*/
+/****************************************************************************************************/
+/* Population with sigmoidal firing rate, scale is 1 for the cortex and C1 for CA3 */
+struct Model_Population {
+	double	Q_max;
+	double	theta;
+	double	sigma;
+	double	scale;
+};
+
+/* Postsynaptic potential driven by the firing rate of population source */
+struct Model_PSP {
+	int		source;
+	double	gamma;
+	double	G;
+	bool	noisy;
+};
+
+/* Contribution weight * y_psp to the sigmoid argument of population target, negative if inhibitory */
+struct Model_Connection {
+	int		target;
+	int		psp;
+	double	weight;
+};
+
+/* Conductance based membrane voltage, starts at E_L */
+struct Model_Membrane {
+	double	tau;
+	double	g_L;
+	double	E_L;
+};
+
+/* Synaptic current weight * y_psp * (V - E) of a membrane */
+struct Model_Conductance {
+	int		membrane;
+	int		psp;
+	double	weight;
+	double	E;
+};
+
+/* Term weight * y_index, or weight * V_index if membrane, of an output channel */
+struct Model_Output {
+	int		channel;
+	bool	membrane;
+	int		index;
+	double	weight;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
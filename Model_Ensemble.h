@@ -0,0 +1,449 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/************************************************************************************************/
+/*						Header file of an ensemble generated from a model description			*/
+/*																								*/
+/*		Holds R independent noisy realizations of the model M, see Model.h, with the memory		*/
+/*		layout and precision modes of Cortical_Ensemble. All loops over the elements of the		*/
+/*		model have compile time bounds and are unrolled, so every SRK stage is one fused pass	*/
+/*		over the realizations, which GCC vectorizes. The table entries are constants of the		*/
+/*		unrolled code, the parameters are copied to the ensemble and may be changed at runtime.	*/
+/*																								*/
+/*		With the descriptions of Models.h the ensembles are bit identical to Cortical_Ensemble	*/
+/*		and CA3_Ensemble, up to rounding of the output sums.									*/
+/************************************************************************************************/
+#pragma once
+#include <array>
+#include <cmath>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "Model.h"
+#include "Profiler.h"
+#include "Random_Stream.h"
+#include "Sigmoid.h"
+#include "SRK_Moments.h"
+using std::vector;
+
+
+/****************************************************************************************************/
+/*								Implementation of the model ensemble 								*/
+/****************************************************************************************************/
+template <typename M, typename T = double, typename S = T>
+class Model_Ensemble {
+public:
+	/* Constructors, realization r is keyed by (seed, r) */
+	Model_Ensemble(int R);
+	Model_Ensemble(int R, uint64_t seed);
+
+	/* Initialize the RNGs */
+	void 	set_RNG		(uint64_t seed);
+
+	/* Set strength of input */
+	void	set_input	(double I) {input = I;}
+
+	/* Number of realizations */
+	int		size		(void) const {return R;}
+
+	/* ODE functions */
+	void 	set_RK		(int);
+	void 	add_RK		(void);
+
+	/* Data storage access, writes the output channels of realization r to out[0, M::channels) */
+	void	get_data	(int r, double* out) const;
+
+	/* Number of elements of the model */
+	static constexpr int N_pop	= std::tuple_size<decltype(M::populations)>::value;
+	static constexpr int N_psp	= std::tuple_size<decltype(M::psps)>::value;
+	static constexpr int N_conn	= std::tuple_size<decltype(M::connections)>::value;
+	static constexpr int N_mem	= std::tuple_size<decltype(M::membranes)>::value;
+	static constexpr int N_cond	= std::tuple_size<decltype(M::conductances)>::value;
+	static constexpr int N_out	= std::tuple_size<decltype(M::outputs)>::value;
+
+	/* Parameters, initialized from the description */
+	std::array<T, N_pop>	Q_max, theta, sigma, scale;
+	std::array<T, N_psp>	gamma, G;
+	std::array<T, N_conn>	weight;
+	std::array<T, N_mem>	tau, g_L, E_L;
+	std::array<T, N_cond>	g_syn, E_syn;
+
+	/* Noise parameter in ms^-1, used from the next drawn noise on */
+	double					dphi	= 5E-3;
+
+private:
+	/* Firing rates of all realizations at the Nth SRK moment */
+	void 	set_Q		(int);
+
+	/* Pointer to the Nth SRK moment of the kth variable of a kind */
+	T*	 			stage	(vector<T>& x, int k, int N) 		{return &x[(5*k + N)*R];}
+	const T*		stage	(const vector<T>& x, int k, int N) const {return &x[(5*k + N)*R];}
+
+	/* Current value of variable k, the accumulated one in mixed precision */
+	S				value	(const vector<T>& x, int i, int k, int r) const
+	{return mixed ? State[k*R+r] : x[5*i*R + r];}
+
+	/* Number of realizations */
+	const int		R;
+
+	/* Draw the noise of all realizations at the current position of the streams */
+	void	draw_noise	(double shift);
+
+	/* Key and common position of the noise streams, 2 per noisy PSP and realization */
+	uint64_t		seed;
+	uint64_t		position;
+
+	/* Container for noise, stream s of realization r is stored at [s*R + r] */
+	vector<T>		Rand_vars;
+
+	/* Normals of the current position and second normal of every Box-Muller pair */
+	vector<double>	Normals;
+	vector<double>	Spare;
+
+	/* Accumulated state of the mixed precision, ordered as membranes, y and x */
+	static constexpr bool mixed = !std::is_same<T, S>::value;
+	vector<S>		State;
+
+	/* Firing rates of the current SRK moment, population i at [i*R, (i+1)*R) */
+	vector<T>		Q;
+
+	/* Input in ms^-1, see set_input */
+	double			input		= 0.0;
+
+	/* Parameters for SRK4 iteration */
+	static constexpr double A[4] = {0.5,  0.5,  1.0, 1.0};
+	static constexpr double B[4] = {0.75, 0.75, 0.0, 0.0};
+
+	/* First noise stream of every PSP, -1 if noise free */
+	std::array<int, N_psp>	stream;
+
+	/* Membrane voltages, PSPs and their derivatives, variable k of a kind at [5*k*R, 5*(k+1)*R) */
+	vector<T>		V, y, x;
+};
+
+template <typename M, typename T, typename S> constexpr double Model_Ensemble<M, T, S>::A[4];
+template <typename M, typename T, typename S> constexpr double Model_Ensemble<M, T, S>::B[4];
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+template <typename M, typename T, typename S>
+Model_Ensemble<M, T, S>::Model_Ensemble(int R)
+: Model_Ensemble(R, rand())
+{}
+
+template <typename M, typename T, typename S>
+Model_Ensemble<M, T, S>::Model_Ensemble(int R, uint64_t seed)
+: R		(R),
+  Q		(N_pop*R),
+  V		(5*N_mem*R), y (5*N_psp*R), x (5*N_psp*R)
+{
+	for (int i=0; i<N_pop; ++i) {
+		Q_max[i]	= M::populations[i].Q_max;
+		theta[i]	= M::populations[i].theta;
+		sigma[i]	= M::populations[i].sigma;
+		scale[i]	= M::populations[i].scale;
+	}
+	for (int p=0; p<N_psp; ++p) {
+		gamma[p]	= M::psps[p].gamma;
+		G[p]		= M::psps[p].G;
+	}
+	for (int c=0; c<N_conn; ++c) {
+		weight[c]	= M::connections[c].weight;
+	}
+	for (int m=0; m<N_mem; ++m) {
+		tau[m]		= M::membranes[m].tau;
+		g_L[m]		= M::membranes[m].g_L;
+		E_L[m]		= M::membranes[m].E_L;
+	}
+	for (int c=0; c<N_cond; ++c) {
+		g_syn[c]	= M::conductances[c].weight;
+		E_syn[c]	= M::conductances[c].E;
+	}
+
+	/* Resting state of the membrane voltages, also in the accumulated state of the mixed precision */
+	State.resize(mixed ? (N_mem + 2*N_psp)*R : 0);
+	for (int m=0; m<N_mem; ++m) {
+		for (int r=0; r<R; ++r) {
+			V[5*m*R + r] = E_L[m];
+			if (mixed) {
+				State[m*R + r] = E_L[m];
+			}
+		}
+	}
+	set_RNG(seed);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Initialization of RNG 										*/
+/****************************************************************************************************/
+template <typename M, typename T, typename S>
+void Model_Ensemble<M, T, S>::set_RNG(uint64_t seed) {
+	/* Number of independent random variables */
+	int N = 0;
+	for (int p=0; p<N_psp; ++p) {
+		stream[p] = M::psps[p].noisy ? 2*N++ : -1;
+	}
+
+	/* Every realization uses the streams (seed, r, column, s), all at the same position */
+	this->seed	= seed;
+	position	= 0;
+	Rand_vars.resize(2*N*R);
+	Normals.resize(R);
+	Spare.resize(2*N*R);
+
+	/* Get the random number for the first iteration */
+	draw_noise(0.0);
+}
+
+/* The streams of all realizations are generated as one block per stream and position */
+template <typename M, typename T, typename S>
+void Model_Ensemble<M, T, S>::draw_noise(double shift) {
+	PROFILE_SCOPE(PROFILE_NOISE);
+	extern const double dt;
+	const int K = Rand_vars.size()/R;
+	for (int s=0; s<K; ++s) {
+		T* __restrict__ z			= &Rand_vars[s*R];
+		double* __restrict__ g		= &Normals[0];
+		double* __restrict__ spare	= &Spare[s*R];
+		if (position & 1) {
+			g = spare;
+		} else {
+			random_stream_philox::normal_pairs(position >> 1, seed, M::column, s, R, g, spare);
+		}
+
+		/* Even streams are I_{l}, odd streams I_{l,0} */
+		const double stddev = s%2 ? dt : dphi*dt;
+		for (int r=0; r<R; ++r) {
+			z[r] = T(0.0 + stddev * g[r] + shift);
+		}
+	}
+	++position;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Firing Rate functions 										*/
+/****************************************************************************************************/
+template <typename M, typename T, typename S>
+void Model_Ensemble<M, T, S>::set_Q (int N) {
+	/* Local copies of the pointers and parameters, see Cortical_Ensemble::set_RK */
+	std::array<const T*, N_psp> yN;
+	std::array<T*, N_pop> q;
+	for (int p=0; p<N_psp; ++p) {
+		yN[p] = stage(y, p, N);
+	}
+	for (int i=0; i<N_pop; ++i) {
+		q[i] = &Q[i*R];
+	}
+	const std::array<T, N_conn> w = weight;
+	const std::array<T, N_pop> th = theta, sg = sigma, sc = scale;
+
+	/* Arguments of the sigmoids, the first connection of a population initializes the sum */
+	#pragma GCC ivdep
+	for (int r=0; r<R; ++r) {
+		#pragma GCC unroll 64
+		for (int i=0; i<N_pop; ++i) {
+			T u = 0;
+			bool first = true;
+			#pragma GCC unroll 64
+			for (int c=0; c<N_conn; ++c) {
+				if (M::connections[c].target == i) {
+					const T v	= w[c] * yN[M::connections[c].psp][r];
+					u			= first ? v : u + v;
+					first		= false;
+				}
+			}
+			q[i][r] = sc[i] * (u - th[i]) / sg[i];
+		}
+	}
+
+	for (int i=0; i<N_pop; ++i) {
+		sigmoid(Q_max[i], q[i], q[i], R);
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Calculate the Nth SRK term									*/
+/****************************************************************************************************/
+template <typename M, typename T, typename S>
+void Model_Ensemble<M, T, S>::set_RK (int N) {
+	PROFILE_SCOPE(PROFILE_ENSEMBLE);
+	extern const double dt;
+	set_Q(N);
+
+	/* Step sizes and noise scaling of the Nth moment */
+	const T h	= A[N]*dt;
+	const T s3	= std::sqrt(T(3));
+	const T b	= B[N];
+
+	/* Initial values, values of the Nth and (N+1)th moment, see Cortical_Ensemble::set_RK */
+	std::array<const T*, N_psp>	y0, yN, x0, xN, q, n0, n1;
+	std::array<T*, N_psp>		y1, x1;
+	std::array<T, N_psp>		hg, Gp, g2;
+	for (int p=0; p<N_psp; ++p) {
+		y0[p]	= stage(y, p, 0);
+		yN[p]	= stage(y, p, N);
+		y1[p]	= stage(y, p, N+1);
+		x0[p]	= stage(x, p, 0);
+		xN[p]	= stage(x, p, N);
+		x1[p]	= stage(x, p, N+1);
+		q[p]	= &Q[M::psps[p].source*R];
+		n0[p]	= stream[p] < 0 ? nullptr : &Rand_vars[ stream[p]   *R];
+		n1[p]	= stream[p] < 0 ? nullptr : &Rand_vars[(stream[p]+1)*R];
+		hg[p]	= h*gamma[p];
+		Gp[p]	= G[p];
+		g2[p]	= gamma[p] * gamma[p];
+	}
+	std::array<const T*, N_mem>	V0, VN;
+	std::array<T*, N_mem>		V1;
+	std::array<T, N_mem>		tm = tau, gL = g_L, EL = E_L;
+	for (int m=0; m<N_mem; ++m) {
+		V0[m]	= stage(V, m, 0);
+		VN[m]	= stage(V, m, N);
+		V1[m]	= stage(V, m, N+1);
+	}
+	const std::array<T, N_cond> gs = g_syn, Es = E_syn;
+
+	#pragma GCC ivdep
+	for (int r=0; r<R; ++r) {
+		/* Leak and synaptic currents, see CA3_Column */
+		#pragma GCC unroll 64
+		for (int m=0; m<N_mem; ++m) {
+			T I = gL[m] * (VN[m][r] - EL[m]);
+			#pragma GCC unroll 64
+			for (int c=0; c<N_cond; ++c) {
+				if (M::conductances[c].membrane == m) {
+					I += yN[M::conductances[c].psp][r] * gs[c] * (VN[m][r] - Es[c]);
+				}
+			}
+			V1[m][r] = V0[m][r] + h*(-I/tm[m]);
+		}
+
+		#pragma GCC unroll 64
+		for (int p=0; p<N_psp; ++p) {
+			y1[p][r] = y0[p][r] + h*(xN[p][r]);
+			if (M::psps[p].noisy) {
+				x1[p][r] = x0[p][r] + hg[p]*(Gp[p] * (q[p][r] - yN[p][r]) - 2 * xN[p][r]) + g2[p] * (n0[p][r] + n1[p][r]/s3)*b;
+			} else {
+				x1[p][r] = x0[p][r] + hg[p]*(Gp[p] * (q[p][r] - yN[p][r]) - 2 * xN[p][r]);
+			}
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Function that adds all SRK terms								*/
+/****************************************************************************************************/
+template <typename M, typename T, typename S>
+void Model_Ensemble<M, T, S>::add_RK(void) {
+	PROFILE_SCOPE(PROFILE_ENSEMBLE);
+	for (int m=0; m<N_mem; ++m) {
+		if (mixed) {
+			add_moments(stage(V, m, 0), &State[m*R], R);
+		} else {
+			add_moments(stage(V, m, 0), R);
+		}
+	}
+	for (int p=0; p<N_psp; ++p) {
+		S* acc_y = mixed ? &State[(N_mem + p)*R] : nullptr;
+		S* acc_x = mixed ? &State[(N_mem + N_psp + p)*R] : nullptr;
+		const T g2 = gamma[p] * gamma[p];
+		if (mixed) {
+			add_moments(stage(y, p, 0), acc_y, R);
+		} else {
+			add_moments(stage(y, p, 0), R);
+		}
+		if (stream[p] < 0) {
+			if (mixed) {
+				add_moments(stage(x, p, 0), acc_x, R);
+			} else {
+				add_moments(stage(x, p, 0), R);
+			}
+		} else {
+			const T* n0 = &Rand_vars[stream[p]*R];
+			const T* n1 = &Rand_vars[(stream[p]+1)*R];
+			if (mixed) {
+				add_moments(stage(x, p, 0), acc_x, n0, n1, g2, R);
+			} else {
+				add_moments(stage(x, p, 0), n0, n1, g2, R);
+			}
+		}
+	}
+
+	/* Generate noise for the next iteration */
+	draw_noise(input);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Data storage access										*/
+/****************************************************************************************************/
+template <typename M, typename T, typename S>
+void Model_Ensemble<M, T, S>::get_data(int r, double* out) const {
+	/* The sums are formed in S as in the hand written ensembles */
+	std::array<S, M::channels> acc;
+	std::array<bool, M::channels> first;
+	first.fill(true);
+	for (int k=0; k<N_out; ++k) {
+		const Model_Output& o = M::outputs[k];
+		const S v = o.membrane ? T(o.weight) * value(V, o.index, o.index, r)
+							   : T(o.weight) * value(y, o.index, N_mem + o.index, r);
+		acc[o.channel]	 = first[o.channel] ? v : acc[o.channel] + v;
+		first[o.channel] = false;
+	}
+	for (int c=0; c<M::channels; ++c) {
+		out[c] = first[c] ? 0.0 : acc[c];
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,50 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Tables of the model descriptions									*/
+/****************************************************************************************************/
+#include "Models.h"
+
+constexpr std::array<Model_Population, 2>	Cortical_Model::populations;
+constexpr std::array<Model_PSP, 6>			Cortical_Model::psps;
+constexpr std::array<Model_Connection, 5>	Cortical_Model::connections;
+constexpr std::array<Model_Membrane, 0>		Cortical_Model::membranes;
+constexpr std::array<Model_Conductance, 0>	Cortical_Model::conductances;
+constexpr std::array<Model_Output, 4>		Cortical_Model::outputs;
+
+constexpr std::array<Model_Population, 2>	CA3_Model::populations;
+constexpr std::array<Model_PSP, 3>			CA3_Model::psps;
+constexpr std::array<Model_Connection, 4>	CA3_Model::connections;
+constexpr std::array<Model_Membrane, 2>		CA3_Model::membranes;
+constexpr std::array<Model_Conductance, 4>	CA3_Model::conductances;
+constexpr std::array<Model_Output, 3>		CA3_Model::outputs;
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
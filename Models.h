@@ -0,0 +1,166 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*						Descriptions of the cortical and the CA3 module								*/
+/*																									*/
+/*		Reproduce Cortical_Column and CA3_Column with their default parameters, see Model.h for	*/
+/*		the equations. The tables are defined in Models.cpp.										*/
+/****************************************************************************************************/
+#pragma once
+#include <array>
+#include "Model.h"
+#include "Model_Ensemble.h"
+
+/****************************************************************************************************/
+/*										Cortical module												*/
+/****************************************************************************************************/
+struct Cortical_Model {
+	/* Population indices, the fast inhibitory rate does not drive any PSP, see Cortical_Column */
+	enum Population	{P, S};
+
+	/* PSP indices */
+	enum PSP		{PP, PS, PF, SA, SB, FA};
+
+	static constexpr RNG_Column		column		= RNG_CORTEX;
+	static constexpr int			channels	= 1;
+
+	static constexpr std::array<Model_Population, 2> populations = {{
+		/* Q_max	theta	sigma	scale */
+		{5.E-3,		1,		0.56,	1},
+		{5.E-3,		6,		0.56,	1}
+	}};
+
+	/* All PSPs rise with gamma_p as in Cortical_Column */
+	static constexpr std::array<Model_PSP, 6> psps = {{
+		/* source	gamma	G		noisy */
+		{P,			180E-3,	5,		true},
+		{P,			180E-3,	5,		true},
+		{P,			180E-3,	5,		true},
+		{S,			180E-3,	50,		false},
+		{S,			180E-3,	3,		false},
+		{S,			180E-3,	20,		false}
+	}};
+
+	static constexpr std::array<Model_Connection, 5> connections = {{
+		/* target	psp		weight */
+		{P,			PP,		 200},
+		{P,			SA,		-240},
+		{P,			FA,		-100},
+		{S,			PS,		 200},
+		{S,			SA,		-400}
+	}};
+
+	static constexpr std::array<Model_Membrane, 0>		membranes		= {{}};
+	static constexpr std::array<Model_Conductance, 0>	conductances	= {{}};
+
+	/* V_C */
+	static constexpr std::array<Model_Output, 4> outputs = {{
+		/* channel	membrane	index	weight */
+		{0,			false,		PP,		 200},
+		{0,			false,		FA,		-100},
+		{0,			false,		SA,		-240},
+		{0,			false,		SB,		-240}
+	}};
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*											CA3 module												*/
+/****************************************************************************************************/
+struct CA3_Model {
+	/* Population, PSP and membrane indices */
+	enum Population	{P, F};
+	enum PSP		{PP, PF, FA};
+	enum Membrane	{V_P, V_F};
+
+	static constexpr RNG_Column		column		= RNG_CA3;
+	static constexpr int			channels	= 2;
+
+	/* The scale is C1 = pi/sqrt(3) */
+	static constexpr std::array<Model_Population, 2> populations = {{
+		/* Q_max	theta	sigma	scale */
+		{30.E-3,	-58.5,	4,		3.14159265/1.7320508075688772},
+		{60.E-3,	-58.5,	6,		3.14159265/1.7320508075688772}
+	}};
+
+	static constexpr std::array<Model_PSP, 3> psps = {{
+		/* source	gamma	G		noisy */
+		{P,			180E-3,	18,		true},
+		{P,			180E-3,	18,		true},
+		{F,			220E-3,	30,		false}
+	}};
+
+	static constexpr std::array<Model_Connection, 4> connections = {{
+		/* target	psp		weight */
+		{P,			PP,		 280},
+		{P,			FA,		-280},
+		{F,			PF,		 600},
+		{F,			FA,		-400}
+	}};
+
+	static constexpr std::array<Model_Membrane, 2> membranes = {{
+		/* tau		g_L		E_L */
+		{1.,		1.,		-60},
+		{1.,		1.,		-60}
+	}};
+
+	/* AMPA and GABA currents */
+	static constexpr std::array<Model_Conductance, 4> conductances = {{
+		/* membrane	psp		weight	E */
+		{V_P,		PP,		1,		0},
+		{V_P,		FA,		280,	-70},
+		{V_F,		PF,		1,		0},
+		{V_F,		FA,		400,	-70}
+	}};
+
+	/* V_H and Y_H */
+	static constexpr std::array<Model_Output, 3> outputs = {{
+		/* channel	membrane	index	weight */
+		{0,			true,		V_P,	 1},
+		{1,			false,		PP,		 280},
+		{1,			false,		FA,		-280}
+	}};
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*								Ensembles of the described modules									*/
+/****************************************************************************************************/
+typedef Model_Ensemble<Cortical_Model>	Cortical_Model_Ensemble;
+typedef Model_Ensemble<CA3_Model>		CA3_Model_Ensemble;
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
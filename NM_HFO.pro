@@ -5,18 +5,59 @@ CONFIG -= qt
 
 TARGET = HFO.cpp
 
-SOURCES +=  CA3_Column.cpp	\
+SOURCES +=  Adaptive_Integrator.cpp \
+	    Burn_In.cpp	\
+	    CA3_Column.cpp	\
+	    CA3_Ensemble.cpp	\
 	    Cortical_Column.cpp \
+	    Cortical_Ensemble.cpp \
+	    Decimator.cpp	\
 	    HFO_mex.cpp		\
-	    HFO.cpp	    
+	    HFO.cpp		\
+	    HFO_Detector.cpp	\
+	    Models.cpp		\
+	    Network.cpp		\
+	    Parameters.cpp	\
+	    Profiler.cpp	\
+	    PSP_Propagator.cpp	\
+	    Random_Stream.cpp	\
+	    Sigmoid.cpp		\
+	    Trace_Reader.cpp	\
+	    Trace_Writer.cpp	\
+	    Welch.cpp
 
-HEADERS +=  CA3_Column.h	\
+HEADERS +=  Adaptive_Integrator.h \
+	    Burn_In.h	\
+	    CA3_Column.h	\
+	    CA3_Ensemble.h	\
 	    Cortical_Column.h	\
+	    Cortical_Ensemble.h	\
 	    Data_Storage.h	\
+	    Decimator.h		\
+	    HFO_Detector.h	\
+	    Model.h		\
+	    Model_Ensemble.h	\
+	    Models.h		\
+	    Network.h		\
 	    ODE.h		\
-	    Random_Stream.h
+	    Parameters.h	\
+	    Profiler.h		\
+	    PSP_Propagator.h	\
+	    Random_Stream.h	\
+	    Sigmoid.h		\
+	    Snapshot.h		\
+	    SRK_Moments.h	\
+	    Trace_Format.h	\
+	    Trace_Reader.h	\
+	    Trace_Writer.h	\
+	    Validation.h	\
+	    Welch.h
     
 
-QMAKE_CXXFLAGS += -std=c++11 -O3
+QMAKE_CXXFLAGS += -std=c++11 -O3 -pthread
+LIBS += -pthread
 
 SOURCES -= HFO_mex.cpp
+
+# Instrumentation of the hot paths, see Profiler.h
+# DEFINES += NM_PROFILE
@@ -0,0 +1,383 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Functions of the column network									*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "Network.h"
+#include "Profiler.h"
+
+/* Nodes per cache line of the rate and afferent arrays, the blocks of the threads start at	*/
+/* multiples of it so that no two threads write to the same cache line						*/
+static const int line = 64/sizeof(double);
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+Network::Network(int cortex, int ca3, const vector<Network_Edge>& edges, uint64_t seed)
+: Nodes		(cortex + ca3),
+  Row		(cortex + ca3 + 1, 0),
+  Afferent	(cortex + ca3, 0.0) {
+	extern const double dt;
+	Cortex.reserve(cortex);
+	CA3.reserve(ca3);
+	for (int i=0; i<cortex; ++i) {
+		Cortex.push_back(Cortical_Column(seed, i));
+	}
+	for (int i=0; i<ca3; ++i) {
+		CA3.push_back(CA3_Column(seed, cortex + i));
+	}
+
+	/* Count the edges of every target, then sort them into the rows */
+	int max_delay = 1;
+	for (const Network_Edge& e : edges) {
+		if (e.source < 0 || e.source >= Nodes || e.target < 0 || e.target >= Nodes) {
+			throw std::invalid_argument("Network: edge between unknown columns");
+		}
+		if (!(e.delay >= 0)) {
+			throw std::invalid_argument("Network: negative delay");
+		}
+		++Row[e.target+1];
+		max_delay = std::max(max_delay, (int) std::lround(e.delay/dt));
+	}
+	for (int i=0; i<Nodes; ++i) {
+		Row[i+1] += Row[i];
+	}
+	Source.resize(edges.size());
+	Delay .resize(edges.size());
+	Gain  .resize(edges.size());
+	vector<int> next(Row.begin(), Row.end()-1);
+	for (const Network_Edge& e : edges) {
+		const int k = next[e.target]++;
+		Source[k]	= e.source;
+		Delay [k]	= std::max(1, (int) std::lround(e.delay/dt));
+		Gain  [k]	= e.gain;
+	}
+	Begin.resize(edges.size());
+	End  .resize(edges.size());
+
+	/* The ring holds the steps [t - max_delay, t + 1] */
+	int length = 1;
+	while (length < max_delay + 2) {
+		length *= 2;
+	}
+	Mask = length - 1;
+	History.resize(length*Nodes);
+	reset_history();
+}
+
+/* Defined here, where the workers are complete */
+Network::~Network() = default;
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Delayed rates 											*/
+/****************************************************************************************************/
+double Network::rate(int node, int N) const {
+	const int C = Cortex.size();
+	return node < C ? Cortex[node].get_Qp(N) : CA3[node - C].get_Qp(N);
+}
+
+/* Before the start the columns are assumed to have been at their current state */
+void Network::reset_history(void) {
+	for (int j=0; j<Nodes; ++j) {
+		const double q = rate(j, 0);
+		for (int s=0; s<=Mask; ++s) {
+			History[s*Nodes + j] = q;
+		}
+	}
+}
+
+void Network::couple(double c, int first, int last) {
+	PROFILE_SCOPE(PROFILE_COUPLING);
+	const int*		__restrict__ row	= &Row[0];
+	const int*		__restrict__ begin	= Begin.data();
+	const int*		__restrict__ end	= End.data();
+	const double*	__restrict__ gain	= Gain.data();
+	const double*	__restrict__ h		= &History[0];
+	double*			__restrict__ phi	= &Afferent[0];
+
+	/* The stages lie at the start, the middle and the end of the step */
+	for (int i=first; i<last; ++i) {
+		double sum = 0.0;
+		if (c == 0.0) {
+			for (int k=row[i]; k<row[i+1]; ++k) {
+				sum += gain[k] * h[begin[k]];
+			}
+		} else if (c == 1.0) {
+			for (int k=row[i]; k<row[i+1]; ++k) {
+				sum += gain[k] * h[end[k]];
+			}
+		} else {
+			for (int k=row[i]; k<row[i+1]; ++k) {
+				sum += gain[k] * ((1-c) * h[begin[k]] + c * h[end[k]]);
+			}
+		}
+		phi[i] = sum;
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Network step 											*/
+/****************************************************************************************************/
+void Network::step(void) {
+	store  (Step, 0, Nodes);
+	advance(Step, 0, Nodes);
+	++Step;
+}
+
+/* Store the rates at the start of the step */
+void Network::store(uint64_t t, int first, int last) {
+	double* h = &History[(t & Mask)*Nodes];
+	for (int j=first; j<last; ++j) {
+		h[j] = rate(j, 0);
+	}
+}
+
+void Network::advance(uint64_t t, int first, int last) {
+	/* Time fractions of the SRK4 stages within the step */
+	static const double c[4] = {0.0, 0.5, 0.5, 1.0};
+	const int C  = Cortex.size();
+	const int c0 = std::min(first, C), c1 = std::min(last, C);
+	const int h0 = std::max(first, C), h1 = std::max(last, C);
+
+	/* Positions of the delayed rates, a delay of d steps reads the steps t-d and t-d+1 */
+	for (int k=Row[first]; k<Row[last]; ++k) {
+		Begin[k] = ((t - Delay[k]	 ) & Mask)*Nodes + Source[k];
+		End	 [k] = ((t - Delay[k] + 1) & Mask)*Nodes + Source[k];
+	}
+
+	/* First calculating every ith RK moment. Has to be in order, 1th moment first */
+	for (int N=0; N<4; ++N) {
+		couple(c[N], first, last);
+		for (int i=c0; i<c1; ++i) {
+			Cortex[i].set_afferent(Afferent[i]);
+			Cortex[i].set_RK(N);
+		}
+		for (int i=h0; i<h1; ++i) {
+			CA3[i-C].set_afferent(Afferent[i]);
+			CA3[i-C].get_RK(N);
+		}
+	}
+
+	/* Add all moments */
+	for (int i=c0; i<c1; ++i) {
+		Cortex[i].add_RK();
+	}
+	for (int i=h0; i<h1; ++i) {
+		CA3[i-C].add_RK();
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Parallel steps	 										*/
+/****************************************************************************************************/
+/* Reusable barrier, the threads spin on the phase counter and yield if it takes longer */
+struct Phase_Barrier {
+	explicit Phase_Barrier(int N) : N(N), waiting(0), phase(0) {}
+
+	void wait(void) {
+		PROFILE_SCOPE(PROFILE_BARRIER);
+		const int p = phase.load(std::memory_order_relaxed);
+		if (waiting.fetch_add(1, std::memory_order_acq_rel) == N-1) {
+			waiting.store(0, std::memory_order_relaxed);
+			phase.store(p+1, std::memory_order_release);
+			return;
+		}
+		for (int spin=0; phase.load(std::memory_order_acquire) == p; ++spin) {
+			if (spin > 1000) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	/* Padded instead of aligned, as C++11 new ignores extended alignment of the workers */
+	const int				N;
+	char					pad_N[64];
+	std::atomic<int>		waiting;
+	char					pad_waiting[64];
+	std::atomic<int>		phase;
+};
+
+/* Block i is advanced by thread i, the calling thread of run() works on block 0. Between calls	*/
+/* the workers spin shortly for the next one and then sleep on a condition variable			*/
+class Network::Workers {
+public:
+	Workers(Network& net, int threads);
+	~Workers();
+
+	int		size	(void) const {return threads;}
+
+	/* Steps of all blocks starting at step t of the network */
+	void	run		(uint64_t t, int steps);
+
+private:
+	void	work	(int i);
+	void	loop	(int i);
+
+	Network&				net;
+	const int				threads;
+
+	/* Contiguous blocks of whole cache lines, the edges of a block are read by its thread only */
+	vector<int>				bound;
+	Phase_Barrier			barrier;
+
+	/* Task of the current call, published by incrementing generation */
+	uint64_t				first	= 0;
+	int						steps	= 0;
+	bool					quit	= false;
+	std::atomic<uint64_t>	generation;
+	std::atomic<int>		pending;
+
+	std::mutex				lock;
+	std::condition_variable	wake, done;
+	vector<std::thread>		pool;
+};
+
+Network::Workers::Workers(Network& net, int threads)
+: net		(net),
+  threads	(threads),
+  bound		(threads+1),
+  barrier	(threads),
+  generation(0),
+  pending	(0) {
+	for (int i=0; i<=threads; ++i) {
+		bound[i] = std::min(net.Nodes, (int) ((int64_t) net.Nodes*i/threads + line-1)/line*line);
+	}
+	bound[threads] = net.Nodes;
+	for (int i=1; i<threads; ++i) {
+		pool.push_back(std::thread(&Workers::loop, this, i));
+	}
+}
+
+Network::Workers::~Workers() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		quit = true;
+		generation.fetch_add(1, std::memory_order_release);
+	}
+	wake.notify_all();
+	for (std::thread& t : pool) {
+		t.join();
+	}
+}
+
+/* The only dependency between blocks are the stored rates of the current step */
+void Network::Workers::work(int i) {
+	for (int t=0; t<steps; ++t) {
+		net.store	(first + t, bound[i], bound[i+1]);
+		barrier.wait();
+		net.advance	(first + t, bound[i], bound[i+1]);
+	}
+}
+
+void Network::Workers::loop(int i) {
+	uint64_t seen = 0;
+	while (true) {
+		for (int spin=0; generation.load(std::memory_order_acquire) == seen && spin < 20000; ++spin) {
+			if (spin > 1000) {
+				std::this_thread::yield();
+			}
+		}
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			wake.wait(guard, [&] {return generation.load(std::memory_order_acquire) != seen;});
+			seen = generation.load(std::memory_order_relaxed);
+			if (quit) {
+				return;
+			}
+		}
+		work(i);
+		if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard<std::mutex> guard(lock);
+			done.notify_one();
+		}
+	}
+}
+
+void Network::Workers::run(uint64_t t, int n) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		first	= t;
+		steps	= n;
+		pending.store(threads-1, std::memory_order_relaxed);
+		generation.fetch_add(1, std::memory_order_release);
+	}
+	wake.notify_all();
+	work(0);
+	for (int spin=0; pending.load(std::memory_order_acquire) > 0 && spin < 20000; ++spin) {
+		if (spin > 1000) {
+			std::this_thread::yield();
+		}
+	}
+	std::unique_lock<std::mutex> guard(lock);
+	done.wait(guard, [&] {return pending.load(std::memory_order_acquire) == 0;});
+}
+
+void Network::run(int steps, int threads) {
+	if (threads <= 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = std::max(1, std::min(threads, (Nodes + line - 1)/line));
+	if (threads == 1) {
+		for (int t=0; t<steps; ++t) {
+			step();
+		}
+		return;
+	}
+
+	/* The workers are kept as long as the number of threads does not change */
+	if (!Pool || Pool->size() != threads) {
+		Pool.reset();
+		Pool.reset(new Workers(*this, threads));
+	}
+	Pool->run(Step, steps);
+	Step += steps;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
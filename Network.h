@@ -0,0 +1,152 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Network of columns											*/
+/*																									*/
+/*		Cortical and CA3 columns are coupled by their pyramidal firing rates. The connectivity		*/
+/*		is a sparse matrix in CSR format, every row lists the afferent edges of a column with		*/
+/*		gain and axonal delay. The rates are kept in a ring buffer per column at the start of		*/
+/*		every step, so the memory grows with columns times the longest delay instead of with		*/
+/*		the number of edges. For the intermediate RK stages the delayed rates are linearly			*/
+/*		interpolated between the steps, and the afferent rates of all columns are evaluated as		*/
+/*		one sparse matrix-vector product per stage.													*/
+/*																									*/
+/*		Nodes [0, cortex) are cortical columns, nodes [cortex, cortex + ca3) CA3 columns.			*/
+/*																									*/
+/*		As every delay is at least one step, the stages of a step never need the stage values of	*/
+/*		other columns. The threads of run() therefore work on contiguous blocks of columns and		*/
+/*		only wait once per step, after every block has stored its rates at the start of the step.	*/
+/*		The worker threads are started by the first parallel call and kept for later calls with	*/
+/*		the same number of threads, so run(1) per recorded step does not create threads. No NUMA	*/
+/*		placement is done, all columns are constructed and thereby first touched by the thread		*/
+/*		creating the network.																		*/
+/****************************************************************************************************/
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CA3_Column.h"
+#include "Cortical_Column.h"
+using std::vector;
+
+/****************************************************************************************************/
+/*										Connection between columns									*/
+/****************************************************************************************************/
+struct Network_Edge {
+	int		source	= 0;
+	int		target	= 0;
+	/* Dimensionless gain of the afferent rate */
+	double	gain	= 0.0;
+	/* Axonal delay in ms, rounded to full steps and at least one step */
+	double	delay	= 0.0;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Implementation of the network								*/
+/****************************************************************************************************/
+class Network {
+public:
+	/* Constructors, node i gets the noise realization (seed, i). Throws std::invalid_argument	*/
+	/* for edges with invalid nodes or negative delays											*/
+	Network(int cortex, int ca3, const vector<Network_Edge>& edges, uint64_t seed = 0);
+	~Network();
+
+	/* The workers refer to the network, so it can neither be copied nor moved */
+	Network(const Network&)				= delete;
+	Network& operator=(const Network&)	= delete;
+
+	/* Number of columns */
+	int		size		(void) const {return Nodes;}
+
+	/* Access to the columns, e.g. for parameters or data storage */
+	Cortical_Column&	cortex	(int i)	{return Cortex[i];}
+	CA3_Column&			ca3		(int i)	{return CA3[i];}
+
+	/* Restart the delay lines with the current rates of all columns, e.g. after changing		*/
+	/* parameters or loading snapshots															*/
+	void	reset_history	(void);
+
+	/* One SRK4 step of all columns */
+	void	step		(void);
+
+	/* Steps of all columns on the given number of threads, 0 for all cores. The result does	*/
+	/* not depend on the number of threads. Waking the workers costs a few microseconds per		*/
+	/* call, so long runs should pass many steps at once										*/
+	void	run			(int steps, int threads = 0);
+
+	/* Afferent rate of a node in the last evaluated stage */
+	double	afferent	(int node) const {return Afferent[node];}
+
+private:
+	/* Pyramidal firing rate of a node at stage N */
+	double	rate		(int node, int N) const;
+
+	/* Store the rates of the nodes [first, last) at the start of step t */
+	void	store		(uint64_t t, int first, int last);
+
+	/* Step t of the nodes [first, last), requires the stored rates of all nodes */
+	void	advance		(uint64_t t, int first, int last);
+
+	/* Afferent rates of the nodes [first, last) at the stage with time fraction c of the step */
+	void	couple		(double c, int first, int last);
+
+	const int					Nodes;
+	vector<Cortical_Column>		Cortex;
+	vector<CA3_Column>			CA3;
+
+	/* CSR connectivity, the edges of target i are [Row[i], Row[i+1]) */
+	vector<int>					Row;
+	vector<int>					Source;
+	vector<int>					Delay;
+	vector<double>				Gain;
+
+	/* Ring buffer of the rates, the rate of node j at step t is at ((t & Mask)*Nodes + j). It	*/
+	/* is one step longer than the longest delay, so step t+1 can be stored while step t is read	*/
+	vector<double>				History;
+	int							Mask	= 0;
+	uint64_t					Step	= 0;
+
+	/* Offsets of the delayed rates at the start and end of the current step for every edge */
+	vector<int>					Begin;
+	vector<int>					End;
+
+	vector<double>				Afferent;
+
+	/* Threads of run(), see Network.cpp. Last, so they stop before the data is destroyed */
+	class Workers;
+	std::unique_ptr<Workers>	Pool;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -32,12 +32,47 @@
 /****************************************************************************************************/
 #pragma once
 #include "CA3_Column.h"
+#include "CA3_Ensemble.h"
 #include "Cortical_Column.h"
+#include "Cortical_Ensemble.h"
+#include "Model_Ensemble.h"
+
+/****************************************************************************************************/
+/*									Precision of the ensembles										*/
+/****************************************************************************************************/
+enum Precision {
+	PRECISION_DOUBLE,		/* Cortical_Ensemble, reference								*/
+	PRECISION_FLOAT,		/* Cortical_Ensemble_Float, all in single precision			*/
+	PRECISION_MIXED			/* Cortical_Ensemble_Mixed, state accumulated in double		*/
+};
+
+inline const char* precision_name(Precision p) {
+	static const char* names[3] = {"double", "float", "mixed"};
+	return names[p];
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
 
 /****************************************************************************************************/
 /*										Evaluation of SRK4											*/
 /****************************************************************************************************/
-void ODE(Cortical_Column& Cortex, CA3_Column& CA3) {
+/* The columns are not coupled, so the fused steps give the same result as the separate stages */
+inline void ODE(Cortical_Column& Cortex, CA3_Column& CA3) {
+	Cortex.step();
+	CA3.step();
+}
+
+/* Exponential integrator, one step of k*dt with k from set_exponential of both columns */
+inline void ODE_exponential(Cortical_Column& Cortex, CA3_Column& CA3) {
+	Cortex.exp_step();
+	CA3.exp_step();
+}
+
+/* Ensemble version, every stage is evaluated for all realizations in one pass */
+template <typename T, typename S>
+inline void ODE(Cortical_Ensemble_T<T, S>& Cortex, CA3_Ensemble_T<T, S>& CA3) {
 	/* First calculating every ith RK moment. Has to be in order, 1th moment first */
 	for (int i=0; i<4; ++i) {
 		Cortex.set_RK(i);
@@ -48,6 +83,18 @@ void ODE(Cortical_Column& Cortex, CA3_Column& CA3) {
 	Cortex.add_RK();
 	CA3.add_RK();
 }
+
+/* Ensembles generated from model descriptions, see Models.h */
+template <typename M1, typename M2, typename T, typename S>
+inline void ODE(Model_Ensemble<M1, T, S>& Cortex, Model_Ensemble<M2, T, S>& CA3) {
+	for (int i=0; i<4; ++i) {
+		Cortex.set_RK(i);
+		CA3.set_RK(i);
+	}
+
+	Cortex.add_RK();
+	CA3.add_RK();
+}
 /****************************************************************************************************/
 /*										 		end													*/
 /****************************************************************************************************/
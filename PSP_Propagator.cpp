@@ -0,0 +1,203 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*							Functions of the exact PSP propagator									*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "PSP_Propagator.h"
+using std::vector;
+
+/****************************************************************************************************/
+/*										Matrix exponential											*/
+/****************************************************************************************************/
+/* exp(A) of a row major n x n matrix by scaling and squaring of the Taylor series. The matrices	*/
+/* are at most 6 x 6 and only computed once, so accuracy is preferred over speed				*/
+static vector<double> expm(vector<double> A, int n) {
+	double norm = 0.0;
+	for (int i=0; i<n; ++i) {
+		double row = 0.0;
+		for (int j=0; j<n; ++j) {
+			row += std::abs(A[i*n+j]);
+		}
+		norm = std::max(norm, row);
+	}
+
+	/* Scale to a norm below 1/2, where 20 terms are accurate to double precision */
+	int squarings = 0;
+	while (norm > 0.5) {
+		norm /= 2;
+		++squarings;
+	}
+	for (double& a : A) {
+		a = std::ldexp(a, -squarings);
+	}
+
+	auto product = [n](const vector<double>& X, const vector<double>& Y) {
+		vector<double> Z(n*n, 0.0);
+		for (int i=0; i<n; ++i) {
+			for (int l=0; l<n; ++l) {
+				for (int j=0; j<n; ++j) {
+					Z[i*n+j] += X[i*n+l] * Y[l*n+j];
+				}
+			}
+		}
+		return Z;
+	};
+
+	vector<double> E(n*n, 0.0), term(n*n, 0.0);
+	for (int i=0; i<n; ++i) {
+		E[i*n+i]	= 1.0;
+		term[i*n+i]	= 1.0;
+	}
+	for (int m=1; m<=20; ++m) {
+		term = product(term, A);
+		for (int i=0; i<n*n; ++i) {
+			term[i] /= m;
+			E[i]	+= term[i];
+		}
+	}
+	for (int s=0; s<squarings; ++s) {
+		E = product(E, E);
+	}
+	return E;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Precomputation												*/
+/****************************************************************************************************/
+/* exp(M h) and the integrals J[p] = int_0^h exp(M s) (h-s)^p/p! ds for p = 0, 1, 2 of a 2x2		*/
+/* matrix M. With the block matrix C = [[M, I, 0, 0], [0, 0, I, 0], [0, 0, 0, I], [0, 0, 0, 0]]	*/
+/* they are the blocks of the first row of exp(C h) (Van Loan)									*/
+static void integrals(const double* M, double h, double* Phi, double J[3][4]) {
+	vector<double> C(64, 0.0);
+	for (int i=0; i<2; ++i) {
+		for (int j=0; j<2; ++j) {
+			C[i*8+j] = M[2*i+j] * h;
+		}
+		for (int p=0; p<3; ++p) {
+			C[(2*p+i)*8+2*p+2+i] = h;
+		}
+	}
+	const vector<double> E = expm(C, 8);
+	for (int i=0; i<2; ++i) {
+		for (int j=0; j<2; ++j) {
+			Phi[2*i+j] = E[i*8+j];
+			for (int p=0; p<3; ++p) {
+				J[p][2*i+j] = E[i*8+2*p+2+j];
+			}
+		}
+	}
+}
+
+void PSP_Propagator::set(double gamma, double G, int k) {
+	extern const double dt;
+	if (k < 1 || k > max_substeps) {
+		throw std::invalid_argument("PSP_Propagator: number of substeps out of range");
+	}
+	this->k = k;
+	const double H = k*dt;
+	const double M[4] = {0.0, 1.0, -gamma*G, -2*gamma};
+
+	/* Interior node after m steps of dt, it coincides with the end for k = 1 */
+	const int m = k > 1 ? k/2 : 1;
+	c = (double) m / k;
+
+	/* The rate Q(s) = sum_l Q_l L_l(s) with the Lagrange polynomials L_l(s) = sum_p a[l][p] s^p	*/
+	/* of the nodes 0, c*H and H, without the interior node for k = 1							*/
+	double a[3][3] = {};
+	if (k > 1) {
+		a[0][0] = 1.0;
+		a[0][1] = -(1 + c) / (c*H);
+		a[0][2] = 1 / (c*H*H);
+		a[1][1] = -1 / (c*(c - 1)*H);
+		a[1][2] = 1 / (c*(c - 1)*H*H);
+		a[2][1] = -c / ((1 - c)*H);
+		a[2][2] = 1 / ((1 - c)*H*H);
+	} else {
+		a[0][0] = 1.0;
+		a[0][1] = -1 / H;
+		a[2][1] = 1 / H;
+	}
+
+	/* int_0^t exp(M (t-s)) s^p ds = p! J[p] for a step of t, which is H for the end and c*H for	*/
+	/* the interior node. The firing rate enters the second component with gamma*G				*/
+	for (int n=0; n<2; ++n) {
+		double J[3][4];
+		integrals(M, n == 0 ? H : c*H, Phi[n], J);
+		for (int i=0; i<2; ++i) {
+			B0[n][i] = J[0][2*i+1] * gamma * G;
+			for (int l=0; l<3; ++l) {
+				W[n][l][i] = (a[l][0] * J[0][2*i+1] + a[l][1] * J[1][2*i+1] + 2 * a[l][2] * J[2][2*i+1]) * gamma * G;
+			}
+		}
+	}
+
+	/* Response v of the SRK4 stages of the linear system to a unit increment c of the x stages */
+	const double A[4] = {0.5,  0.5,  1.0, 1.0};
+	const double B[4] = {0.75, 0.75, 0.0, 0.0};
+	double u[5][2] = {{0.0, 0.0}};
+	for (int N=0; N<4; ++N) {
+		u[N+1][0] = A[N]*dt * (M[0] * u[N][0] + M[1] * u[N][1]);
+		u[N+1][1] = A[N]*dt * (M[2] * u[N][0] + M[3] * u[N][1]) + B[N];
+	}
+	double v[2];
+	for (int i=0; i<2; ++i) {
+		v[i] = (2*u[1][i] + 4*u[2][i] + 2*u[3][i] + u[4][i])/6;
+	}
+
+	/* Noise[j][n] maps (c, a) of substep j to the end of the step and to the interior node, the	*/
+	/* substeps after the interior node do not reach it											*/
+	for (int j=0; j<max_substeps; ++j) {
+		for (int n=0; n<2; ++n) {
+			const int last = n == 0 ? k : m;
+			double* N = Noise[j][n];
+			if (j >= last) {
+				std::fill(N, N+4, 0.0);
+				continue;
+			}
+			const double tau = (last - j - 1) * dt;
+			const vector<double> P = expm({M[0]*tau, M[1]*tau, M[2]*tau, M[3]*tau}, 2);
+			N[0] = P[0] * v[0] + P[1] * v[1];
+			N[1] = P[1];
+			N[2] = P[2] * v[0] + P[3] * v[1];
+			N[3] = P[3];
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
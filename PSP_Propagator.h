@@ -0,0 +1,132 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*							Exact propagation of a linear PSP subsystem								*/
+/*																									*/
+/*		Every PSP of the columns is a linear second order filter of its firing rate Q				*/
+/*			y' = x,		x' = gamma * (G * (Q - y) - 2 * x)											*/
+/*		i.e. u' = M u + gamma*G*Q e_2 with u = (y, x). Over a step H = k*dt the linear part is		*/
+/*		propagated exactly with the matrix exponential exp(M H). Only the firing rate is			*/
+/*		treated numerically, by exponential collocation at the start, an interior node c*H and		*/
+/*		the end of the step. Q(s) is the quadratic through the rates at the three nodes, so			*/
+/*			u(t) = exp(M t) u_n + int_0^t exp(M (t-s)) gamma*G*Q(s) e_2 ds + noise(t)				*/
+/*		at t = c*H and t = H is linear in the three rates with weights precomputed exactly.			*/
+/*		The states at the nodes and their rates are iterated from the exponential Euler guess		*/
+/*			u* = exp(M t) u_n + int_0^t exp(M s) ds gamma*G*Q(u_n) e_2 + noise(t)					*/
+/*		which is kept as embedded predictor. The firing rates couple the PSPs of a column, so		*/
+/*		every iteration has to be applied to all of them before the rates are evaluated anew.		*/
+/*																									*/
+/*		The noise of the k steps of dt is that of SRK4. The response of the SRK4 stages of the		*/
+/*		linear system to the increments of substep j is propagated exactly to the interior node,	*/
+/*		c*H = (k/2)*dt, and to the end of the step, so both integrators follow the same path of the	*/
+/*		noise and the rate at the interior node sees the noise of the first half of the step.		*/
+/*		Steps of a single dt have no interior node of the noise, there Q is linear in s.			*/
+/****************************************************************************************************/
+#pragma once
+
+/****************************************************************************************************/
+/*									Implementation of the propagator								*/
+/****************************************************************************************************/
+class PSP_Propagator {
+public:
+	/* Maximal number of steps of dt per step of the propagator */
+	static const int max_substeps = 16;
+
+	/* Longest fixed step of the columns in steps of dt. Up to it the bursts of CA3 match SRK4 in	*/
+	/* validate_equivalence, longer steps lose up to half of the variance of V_H and are only		*/
+	/* taken by the adaptive integrator, whose error control shortens them within bursts			*/
+	static const int max_fixed_substeps = 4;
+
+	/* Number of collocation iterations of a step */
+	static const int iterations = 2;
+
+	/* Precomputes the matrices for rise time gamma, amplitude G and steps of k*dt. Throws		*/
+	/* std::invalid_argument if k is not in [1, max_substeps]									*/
+	void	set			(double gamma, double G, int k);
+
+	/* Number of steps of dt per step */
+	int		substeps	(void) const {return k;}
+
+	/* Time of the interior node relative to the step */
+	double	interior	(void) const {return c;}
+
+	/* Adds the noise of substep j to the accumulated noise, noise[0..1] at the end of the step	*/
+	/* and noise[2..3] at the interior node. c enters the x stages of SRK4 with weights B[N] and	*/
+	/* a is added to x after the stages, see noise_xRK and noise_aRK								*/
+	void	add_noise	(int j, double c, double a, double* noise) const {
+		for (int n=0; n<2; ++n) {
+			const double* P = Noise[j][n];
+			noise[2*n]	 += P[0] * c + P[1] * a;
+			noise[2*n+1] += P[2] * c + P[3] * a;
+		}
+	}
+
+	/* Exponential Euler from (y[0], x[0]) with firing rate Q into (y[1], x[1]) as predictor, and	*/
+	/* as first guess of the end (y[2], x[2]) and of the interior node (y[3], x[3])				*/
+	void	predict		(double* y, double* x, double Q, const double* noise) const {
+		for (int n=0; n<2; ++n) {
+			const double* P = Phi[n];
+			y[2+n] = P[0] * y[0] + P[1] * x[0] + B0[n][0] * Q + noise[2*n];
+			x[2+n] = P[2] * y[0] + P[3] * x[0] + B0[n][1] * Q + noise[2*n+1];
+		}
+		y[1] = y[2];
+		x[1] = x[2];
+	}
+
+	/* Collocation iteration with the firing rates at the start, of the interior node (y[3], x[3])	*/
+	/* and of the end (y[2], x[2]) of the previous iteration, updates both						*/
+	void	collocate	(double* y, double* x, double Q0, double Qc, double Q1, const double* noise) const {
+		for (int n=0; n<2; ++n) {
+			const double* P = Phi[n];
+			const double (*w)[2] = W[n];
+			y[2+n] = P[0] * y[0] + P[1] * x[0] + w[0][0] * Q0 + w[1][0] * Qc + w[2][0] * Q1 + noise[2*n];
+			x[2+n] = P[2] * y[0] + P[3] * x[0] + w[0][1] * Q0 + w[1][1] * Qc + w[2][1] * Q1 + noise[2*n+1];
+		}
+	}
+
+	/* Takes the end (y[2], x[2]) as new state */
+	void	accept		(double* y, double* x) const {
+		y[0] = y[2];
+		x[0] = x[2];
+	}
+
+private:
+	/* Row major 2x2 matrices and vectors of the scheme, first index 0 for the end of the step and	*/
+	/* 1 for the interior node. W[n][l] is the weight of the rate at node l (start, interior, end)	*/
+	double	Phi[2][4]					= {{1.0, 0.0, 0.0, 1.0}, {1.0, 0.0, 0.0, 1.0}};
+	double	B0 [2][2]					= {};
+	double	W  [2][3][2]				= {};
+	double	Noise[max_substeps][2][4]	= {};
+	int		k							= 0;
+	double	c							= 1.0;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
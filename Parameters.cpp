@@ -0,0 +1,114 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Functions of parameter sets									*/
+/****************************************************************************************************/
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "Parameters.h"
+
+/****************************************************************************************************/
+/*										 	Application 											*/
+/****************************************************************************************************/
+/* Columns and ensembles share the names of the parameters */
+template <typename Cortical, typename CA3_Type>
+static bool apply_pair(const Parameter_Set& params, Cortical& Cortex, CA3_Type& CA3) {
+	for (const auto& p : params) {
+		const std::string param = p.first.size() > 2 ? p.first.substr(2) : "";
+		const bool known = (p.first.compare(0, 2, "C.") == 0 && Cortex.set_param(param, p.second)) ||
+						   (p.first.compare(0, 2, "H.") == 0 && CA3.set_param(param, p.second));
+		if (!known) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool apply_params(const Parameter_Set& params, Cortical_Column& Cortex, CA3_Column& CA3) {
+	return apply_pair(params, Cortex, CA3);
+}
+
+template <typename T, typename S>
+bool apply_params(const Parameter_Set& params, Cortical_Ensemble_T<T, S>& Cortex, CA3_Ensemble_T<T, S>& CA3) {
+	return apply_pair(params, Cortex, CA3);
+}
+
+template bool apply_params(const Parameter_Set&, Cortical_Ensemble&,		CA3_Ensemble&);
+template bool apply_params(const Parameter_Set&, Cortical_Ensemble_Float&,	CA3_Ensemble_Float&);
+template bool apply_params(const Parameter_Set&, Cortical_Ensemble_Mixed&,	CA3_Ensemble_Mixed&);
+
+/* Every parameter is checked on its own on a dummy pair, so no value can hide a name */
+void check_params(const Parameter_Set& params) {
+	Cortical_Column Cortex(0);
+	CA3_Column		CA3(0);
+	for (const auto& p : params) {
+		if (!apply_params(Parameter_Set(1, p), Cortex, CA3)) {
+			throw std::invalid_argument("unknown parameter " + p.first);
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Parameter files 										*/
+/****************************************************************************************************/
+Parameter_Set read_params(const std::string& file) {
+	std::ifstream in(file);
+	if (!in) {
+		throw std::runtime_error("cannot open parameter file " + file);
+	}
+	Parameter_Set params;
+	std::string line;
+	for (int n=1; std::getline(in, line); ++n) {
+		line = line.substr(0, line.find('#'));
+		if (line.find_first_not_of(" \t\r") == std::string::npos) {
+			continue;
+		}
+
+		/* name = value, nothing else on the line */
+		const size_t split = line.find('=');
+		std::istringstream	name_field (line.substr(0, split));
+		std::istringstream	value_field(split == std::string::npos ? "" : line.substr(split+1));
+		std::string			name, rest;
+		double				value;
+		if (!(name_field >> name) || (name_field >> rest) || !(value_field >> value) || (value_field >> rest)) {
+			throw std::runtime_error(file + ":" + std::to_string(n) + ": expected <name> = <value>");
+		}
+		params.push_back(std::make_pair(name, value));
+	}
+	return params;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,66 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*											Parameter sets											*/
+/*																									*/
+/*		A parameter set is a list of pairs ("C.<param>" or "H.<param>", value) with the names		*/
+/*		of Cortical_Column::set_param and CA3_Column::set_param, which the ensembles share.		*/
+/*		Later pairs override earlier ones. Parameter files hold one pair per line, e.g.			*/
+/*		"H.N_pp = 300", text after # is ignored.													*/
+/****************************************************************************************************/
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "CA3_Column.h"
+#include "CA3_Ensemble.h"
+#include "Cortical_Column.h"
+#include "Cortical_Ensemble.h"
+using std::vector;
+
+typedef vector<std::pair<std::string, double>> Parameter_Set;
+
+/* Apply the parameters to a pair of columns, returns false for an unknown parameter */
+bool			apply_params	(const Parameter_Set& params, Cortical_Column& Cortex, CA3_Column& CA3);
+
+/* Apply the parameters to all realizations of a pair of ensembles, returns false for an		*/
+/* unknown parameter																			*/
+template <typename T, typename S>
+bool			apply_params	(const Parameter_Set& params, Cortical_Ensemble_T<T, S>& Cortex,
+								 CA3_Ensemble_T<T, S>& CA3);
+
+/* Throws std::invalid_argument naming the first unknown parameter */
+void			check_params	(const Parameter_Set& params);
+
+/* Read a parameter file, throws std::runtime_error if it cannot be read or a line is malformed */
+Parameter_Set	read_params		(const std::string& file);
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -1,5 +1,5 @@
 % mex command is given by: 
-% mex CXXFLAGS="\$CXXFLAGS -std=c++11 -O3" HFO_mex.cpp CA3_Column.cpp Cortical_Column.cpp
+% mex CXXFLAGS="\$CXXFLAGS -std=c++11 -O3" HFO_mex.cpp CA3_Column.cpp Cortical_Column.cpp CA3_Ensemble.cpp Cortical_Ensemble.cpp Decimator.cpp PSP_Propagator.cpp Random_Stream.cpp Sigmoid.cpp Burn_In.cpp Parameters.cpp
 
 function Plots(T)
 
@@ -7,27 +7,28 @@ if nargin == 0
     T       	= 120;  		% duration of the simulation
 end
 
-mex CXXFLAGS="\$CXXFLAGS -std=c++11 -O3" HFO_mex.cpp CA3_Column.cpp Cortical_Column.cpp;
+mex CXXFLAGS="\$CXXFLAGS -std=c++11 -O3" HFO_mex.cpp CA3_Column.cpp Cortical_Column.cpp CA3_Ensemble.cpp Cortical_Ensemble.cpp Decimator.cpp PSP_Propagator.cpp Random_Stream.cpp Sigmoid.cpp Burn_In.cpp Parameters.cpp;
 
-[V_C, V_H, Y_H] = HFO_mex(T, 0, 0);
+% V_C is only analysed below 400 Hz and stored at 1 kHz, V_H and Y_H at the full 10 kHz
+Rates           = [1000, 10000, 10000];
+[V_C, V_H, Y_H] = HFO_mex(T, 0, 0, Rates);
 
-L        = max(size(V_C));
-timeaxis = linspace(0,T,L);
+timeaxis_C = linspace(0,T,max(size(V_C)));
+timeaxis_H = linspace(0,T,max(size(V_H)));
 
 figure(1)
-subplot(311), plot(timeaxis,V_C)
+subplot(311), plot(timeaxis_C,V_C)
 title('Cortex membrane voltage'), xlabel('time in s'), ylabel('V_C in mV')
-subplot(312), plot(timeaxis,V_H)
+subplot(312), plot(timeaxis_H,V_H)
 title('HFO membrane voltage'), xlabel('time in s'), ylabel('V_H in mV')
-subplot(313), plot(timeaxis,V_H)
+subplot(313), plot(timeaxis_H,V_H)
 title('HFO synaptic drive'), xlabel('time in s'), ylabel('Y_H in mV')
 
-Fs          = L/T;
-[Pxx_C,f_C] = pwelch(V_C-mean(V_C), [], [], [], Fs);
+[Pxx_C,f_C] = pwelch(V_C-mean(V_C), [], [], [], Rates(1));
 n_C         = find(f_C<=400, 1, 'last' );
-[Pxx_H,f_H] = pwelch(V_H-mean(V_H), [], [], [], Fs);
+[Pxx_H,f_H] = pwelch(V_H-mean(V_H), [], [], [], Rates(2));
 n_H         = find(f_H<=400, 1, 'last' );
-[Pxx_Y,f_Y] = pwelch(Y_H-mean(Y_H), [], [], [], Fs);
+[Pxx_Y,f_Y] = pwelch(Y_H-mean(Y_H), [], [], [], Rates(3));
 n_Y         = find(f_Y<=400, 1, 'last' );
 
 figure(2)
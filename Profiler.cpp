@@ -0,0 +1,254 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Implementation of the instrumentation							*/
+/****************************************************************************************************/
+#include "Profiler.h"
+#ifdef NM_PROFILE
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/****************************************************************************************************/
+/*										 	Counters 												*/
+/****************************************************************************************************/
+struct Profile_Counters {
+	uint64_t	ticks[PROFILE_PHASES] = {};
+	uint64_t	calls[PROFILE_PHASES] = {};
+
+	void add(const Profile_Counters& other) {
+		for (int p=0; p<PROFILE_PHASES; ++p) {
+			ticks[p] += other.ticks[p];
+			calls[p] += other.calls[p];
+		}
+	}
+};
+
+struct Profile_Thread;
+
+/* Counters of the finished threads, the live threads and the start of the measurement */
+static std::mutex								registry_lock;
+static Profile_Counters							finished;
+static std::vector<Profile_Thread*>				live;
+static uint64_t									start_ticks = profile_ticks();
+static std::chrono::steady_clock::time_point	start_time	= std::chrono::steady_clock::now();
+
+/* Counters of a thread, merged into the finished ones when the thread ends. They are atomic, as	*/
+/* reports read them while the thread runs. Only the owning thread increments them, so a relaxed	*/
+/* load and store suffices and no locked instruction is needed on the hot path					*/
+struct Profile_Thread {
+	std::atomic<uint64_t>	ticks[PROFILE_PHASES];
+	std::atomic<uint64_t>	calls[PROFILE_PHASES];
+
+	Profile_Thread(void) {
+		clear();
+		std::lock_guard<std::mutex> guard(registry_lock);
+		live.push_back(this);
+	}
+	~Profile_Thread() {
+		std::lock_guard<std::mutex> guard(registry_lock);
+		finished.add(read());
+		for (unsigned i=0; i<live.size(); ++i) {
+			if (live[i] == this) {
+				live.erase(live.begin() + i);
+				break;
+			}
+		}
+	}
+
+	void add(Profile_Phase phase, uint64_t t) {
+		ticks[phase].store(ticks[phase].load(std::memory_order_relaxed) + t, std::memory_order_relaxed);
+		calls[phase].store(calls[phase].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	Profile_Counters read(void) const {
+		Profile_Counters c;
+		for (int p=0; p<PROFILE_PHASES; ++p) {
+			c.ticks[p] = ticks[p].load(std::memory_order_relaxed);
+			c.calls[p] = calls[p].load(std::memory_order_relaxed);
+		}
+		return c;
+	}
+
+	void clear(void) {
+		for (int p=0; p<PROFILE_PHASES; ++p) {
+			ticks[p].store(0, std::memory_order_relaxed);
+			calls[p].store(0, std::memory_order_relaxed);
+		}
+	}
+};
+
+static thread_local Profile_Thread this_thread;
+
+uint64_t profile_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void profile_add(Profile_Phase phase, uint64_t ticks) {
+	this_thread.add(phase, ticks);
+}
+
+void profile_reset(void) {
+	std::lock_guard<std::mutex> guard(registry_lock);
+	finished = Profile_Counters();
+	for (Profile_Thread* t : live) {
+		t->clear();
+	}
+	start_ticks = profile_ticks();
+	start_time	= std::chrono::steady_clock::now();
+}
+
+/* Scopes of other threads that are still open are not counted yet, and ticks and calls of a	*/
+/* phase may be one scope apart																	*/
+void profile_report(std::ostream& out) {
+	static const char* names[PROFILE_PHASES] = {"RK stages cortex", "RK stages CA3", "add_RK",
+												"noise refill", "sigmoid arrays", "ensemble steps",
+												"network coupling", "network barrier", "data storage"};
+	Profile_Counters total;
+	{
+		std::lock_guard<std::mutex> guard(registry_lock);
+		total = finished;
+		for (const Profile_Thread* t : live) {
+			total.add(t->read());
+		}
+	}
+
+	/* Ticks per second over the measured interval, to convert the ticks into seconds */
+	const double seconds	= std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	const double rate		= seconds > 0 ? (profile_ticks() - start_ticks)/seconds : 1E9;
+
+	out << "profile over " << seconds << " s (inclusive times, all threads)\n";
+	char line[128];
+	std::snprintf(line, sizeof(line), "  %-18s %14s %14s %12s %10s\n", "phase", "calls", "ticks", "ticks/call", "seconds");
+	out << line;
+	for (int p=0; p<PROFILE_PHASES; ++p) {
+		if (!total.calls[p]) {
+			continue;
+		}
+		std::snprintf(line, sizeof(line), "  %-18s %14llu %14llu %12.1f %10.4f\n", names[p],
+					  (unsigned long long) total.calls[p], (unsigned long long) total.ticks[p],
+					  (double) total.ticks[p]/total.calls[p], total.ticks[p]/rate);
+		out << line;
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Hardware counters											*/
+/****************************************************************************************************/
+#ifdef __linux__
+static int open_counter(uint64_t config, int group) {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.type			= PERF_TYPE_HARDWARE;
+	attr.size			= sizeof(attr);
+	attr.config			= config;
+	attr.disabled		= group < 0;
+	attr.exclude_kernel	= 1;
+	attr.exclude_hv		= 1;
+	return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+Perf_Counters::Perf_Counters(void) {
+	const uint64_t config[N] = {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES};
+	fd[0] = open_counter(config[0], -1);
+	for (int i=1; i<N; ++i) {
+		fd[i] = fd[0] < 0 ? -1 : open_counter(config[i], fd[0]);
+	}
+}
+
+Perf_Counters::~Perf_Counters() {
+	for (int i=0; i<N; ++i) {
+		if (fd[i] >= 0) {
+			close(fd[i]);
+		}
+	}
+}
+
+void Perf_Counters::start(void) {
+	if (fd[0] >= 0) {
+		ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+void Perf_Counters::stop(void) {
+	if (fd[0] >= 0) {
+		ioctl(fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+void Perf_Counters::report(std::ostream& out) const {
+	static const char* names[N] = {"instructions", "cycles", "cache misses"};
+	for (int i=0; i<N; ++i) {
+		uint64_t value;
+		if (fd[i] >= 0 && read(fd[i], &value, sizeof(value)) == sizeof(value)) {
+			out << "  " << names[i] << ": " << value << "\n";
+		} else {
+			out << "  " << names[i] << ": not available\n";
+		}
+	}
+}
+#else
+Perf_Counters::Perf_Counters(void) {
+	for (int i=0; i<N; ++i) {
+		fd[i] = -1;
+	}
+}
+Perf_Counters::~Perf_Counters() {}
+void Perf_Counters::start(void) {}
+void Perf_Counters::stop(void) {}
+void Perf_Counters::report(std::ostream& out) const {
+	out << "  hardware counters not available\n";
+}
+#endif
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+#endif
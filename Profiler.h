@@ -0,0 +1,143 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Hot path instrumentation									*/
+/*																									*/
+/*		Compiled only with -DNM_PROFILE, otherwise every macro expands to nothing and the report	*/
+/*		functions are empty. PROFILE_SCOPE(phase) adds the time stamp counter ticks and the call	*/
+/*		count of the enclosing scope to the phase. The counters are per thread and are merged		*/
+/*		when a thread ends or a report is written, which may happen while other threads run.		*/
+/*		Phases may be nested, e.g. the noise refill within add_RK, the reported times are		*/
+/*		inclusive.																					*/
+/*																									*/
+/*		Perf_Counters reads instructions, cycles and cache misses of the calling thread via		*/
+/*		perf_event_open on Linux, where the kernel allows it.										*/
+/****************************************************************************************************/
+#pragma once
+#include <cstdint>
+#include <ostream>
+
+/****************************************************************************************************/
+/*										Instrumented phases											*/
+/****************************************************************************************************/
+enum Profile_Phase {
+	PROFILE_RK_CORTEX,		/* Cortical_Column::set_RK, step and exp_step	*/
+	PROFILE_RK_CA3,			/* CA3_Column::get_RK, step and exp_step		*/
+	PROFILE_ADD_RK,			/* add_RK of both columns						*/
+	PROFILE_NOISE,			/* refill of the noise blocks					*/
+	PROFILE_SIGMOID,		/* array sigmoid kernels						*/
+	PROFILE_ENSEMBLE,		/* stages and add_RK of the ensembles			*/
+	PROFILE_COUPLING,		/* afferent rates of the network				*/
+	PROFILE_BARRIER,		/* waiting of the network threads				*/
+	PROFILE_STORAGE,		/* data storage, traces and online analysis		*/
+	PROFILE_PHASES
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+#ifdef NM_PROFILE
+/****************************************************************************************************/
+/*										Counters of a scope											*/
+/****************************************************************************************************/
+/* Current value of the time stamp counter, or of a nanosecond clock on other architectures */
+uint64_t	profile_ticks	(void);
+
+/* Add ticks and one call to a phase of the calling thread */
+void		profile_add		(Profile_Phase phase, uint64_t ticks);
+
+class Profile_Scope {
+public:
+	explicit Profile_Scope(Profile_Phase phase) : phase(phase), start(profile_ticks()) {}
+	~Profile_Scope() {profile_add(phase, profile_ticks() - start);}
+
+	Profile_Scope(const Profile_Scope&)				= delete;
+	Profile_Scope& operator=(const Profile_Scope&)	= delete;
+
+private:
+	const Profile_Phase	phase;
+	const uint64_t		start;
+};
+
+#define PROFILE_JOIN2(a, b)		a##b
+#define PROFILE_JOIN(a, b)		PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(phase)	Profile_Scope PROFILE_JOIN(profile_scope_, __LINE__)(phase)
+
+/* Breakdown of all phases over all threads so far */
+void	profile_report	(std::ostream& out);
+
+/* Reset all counters */
+void	profile_reset	(void);
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Hardware counters											*/
+/****************************************************************************************************/
+class Perf_Counters {
+public:
+	Perf_Counters(void);
+	~Perf_Counters();
+
+	Perf_Counters(const Perf_Counters&)				= delete;
+	Perf_Counters& operator=(const Perf_Counters&)	= delete;
+
+	/* Counting is limited to the time between start and stop */
+	void	start	(void);
+	void	stop	(void);
+
+	/* Counts of all intervals between start and stop so far, "not available" if the kernel		*/
+	/* denies access																			*/
+	void	report	(std::ostream& out) const;
+
+private:
+	static const int	N = 3;
+	int					fd[N];
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+#else
+#define PROFILE_SCOPE(phase)
+
+inline void profile_report	(std::ostream&) {}
+inline void profile_reset	(void) {}
+
+class Perf_Counters {
+public:
+	void	start	(void) {}
+	void	stop	(void) {}
+	void	report	(std::ostream&) const {}
+};
+#endif
@@ -0,0 +1,168 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *              Stefanie Gareis: gareis@inb.uni-luebeck.de
+ */
+
+/****************************************************************************************************/
+/*								Block kernels of the random number streams							*/
+/*																									*/
+/*		Both kernels are written as plain loops over independent elements with polynomial			*/
+/*		log, sin and cos instead of libm, so that the compiler vectorizes them. They are cloned		*/
+/*		for AVX-512, AVX2 and the baseline instruction set, and the loader picks the widest		*/
+/*		variant the CPU supports. All clones evaluate the same operations in the same order.		*/
+/****************************************************************************************************/
+#include <cmath>
+#include <cstring>
+#include "Random_Stream.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__clang__)
+#define RNG_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+/* Without contraction to FMA the vector body and the scalar tail round alike */
+#pragma GCC optimize ("fp-contract=off")
+#else
+#define RNG_CLONES
+#endif
+
+/* Bit casts between double and its IEEE 754 representation */
+static inline double	as_double	(uint64_t x) {double d; std::memcpy(&d, &x, 8); return d;}
+static inline uint64_t	as_bits		(double d)	 {uint64_t x; std::memcpy(&x, &d, 8); return x;}
+
+/****************************************************************************************************/
+/*										Philox uniforms												*/
+/****************************************************************************************************/
+/* The upper 52 bits of hi:lo form the mantissa of a double in [1, 2) */
+static inline double unit_interval(uint32_t hi, uint32_t lo) {
+	return as_double(UINT64_C(0x3FF0000000000000) | (((uint64_t) hi << 32 | lo) >> 12));
+}
+
+RNG_CLONES
+void philox_uniforms (uint64_t seed, uint64_t n, uint64_t dn, uint32_t r, uint32_t dr, uint32_t stream,
+					  int M, double* __restrict__ u1, double* __restrict__ u2) {
+	for (int k=0; k<M; ++k) {
+		const uint64_t ctr = n + k*dn;
+		uint32_t c0 = (uint32_t) ctr, c1 = (uint32_t) (ctr >> 32), c2 = r + k*dr, c3 = stream;
+		philox4x32::generate(c0, c1, c2, c3, (uint32_t) seed, (uint32_t) (seed >> 32));
+
+		/* u1 in (0, 1] for the logarithm, u2 in [0, 1) for the angle */
+		u1[k] = 2.0 - unit_interval(c0, c1);
+		u2[k] = unit_interval(c2, c3) - 1.0;
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Box-Muller transform										*/
+/****************************************************************************************************/
+/* Natural logarithm of normal positive x, the mantissa is reduced to [sqrt(1/2), sqrt(2)) and		*/
+/* ln(m) = 2 atanh(s) with s = (m-1)/(m+1) is summed up to s^21, |s| < 0.172						*/
+static inline double log_kernel(double x) {
+	/* Offsetting the bits by those of sqrt(1/2) moves the exponent boundary to sqrt(2) */
+	const uint64_t	offset	= UINT64_C(0x3FE6A09E667F3BCD);
+	const uint64_t	ix		= as_bits(x) - offset;
+	const double	m		= as_double((ix & UINT64_C(0x000FFFFFFFFFFFFF)) + offset);
+	/* Exponent as double via the 2^52 offset, biased by 2048 to stay unsigned */
+	const double	e		= as_double(UINT64_C(0x4330000000000000) | ((ix + (UINT64_C(2048) << 52)) >> 52))
+							- (4503599627370496.0 + 2048.0);
+
+	const double s	= (m - 1.0) / (m + 1.0);
+	const double s2	= s * s;
+	double p = 1.0/21;
+	p = p * s2 + 1.0/19;
+	p = p * s2 + 1.0/17;
+	p = p * s2 + 1.0/15;
+	p = p * s2 + 1.0/13;
+	p = p * s2 + 1.0/11;
+	p = p * s2 + 1.0/9;
+	p = p * s2 + 1.0/7;
+	p = p * s2 + 1.0/5;
+	p = p * s2 + 1.0/3;
+	const double ln_m = 2.0*s + 2.0*s*s2*p;
+
+	/* ln(2) split such that e * ln2_hi is exact */
+	const double ln2_hi = 6.93147180369123816490E-1;
+	const double ln2_lo = 1.90821492927058770002E-10;
+	return e*ln2_hi + (e*ln2_lo + ln_m);
+}
+
+/* Cosine and sine of 2 pi u for u in [0, 1), reduced by quarter turns to |x| <= pi/4 */
+static inline void sincos_kernel(double u, double& c, double& s) {
+	const double	t	= 4.0 * u;
+	/* Round to nearest via the 1.5*2^52 offset, the low bits hold the quadrant */
+	const double	big	= t + 6755399441055744.0;
+	const uint64_t	q	= as_bits(big);
+	const double	x	= (t - (big - 6755399441055744.0)) * 1.57079632679489661923;
+	const double	x2	= x * x;
+
+	double ps = -1.0/1307674368000;
+	ps = ps * x2 + 1.0/6227020800;
+	ps = ps * x2 - 1.0/39916800;
+	ps = ps * x2 + 1.0/362880;
+	ps = ps * x2 - 1.0/5040;
+	ps = ps * x2 + 1.0/120;
+	ps = ps * x2 - 1.0/6;
+	const double sx = x + x*x2*ps;
+
+	double pc = 1.0/20922789888000;
+	pc = pc * x2 - 1.0/87178291200;
+	pc = pc * x2 + 1.0/479001600;
+	pc = pc * x2 - 1.0/3628800;
+	pc = pc * x2 + 1.0/40320;
+	pc = pc * x2 - 1.0/720;
+	pc = pc * x2 + 1.0/24;
+	pc = pc * x2 - 0.5;
+	const double cx = 1.0 + x2*pc;
+
+	/* cos(q pi/2 + x) and sin(q pi/2 + x) */
+	const uint64_t	sign	= UINT64_C(0x8000000000000000);
+	const bool		odd		= q & 1;
+	c = as_double(as_bits(odd ? sx : cx) ^ (((q + 1) & 2) ? sign : 0));
+	s = as_double(as_bits(odd ? cx : sx) ^ ((q & 2) ? sign : 0));
+}
+
+RNG_CLONES
+void box_muller (const double* u1, const double* u2, double* z0, double* z1, int M) {
+	/* sqrt may set errno and would stop the vectorization, so it gets a separate pass per chunk */
+	const int	chunk = 64;
+	double		rho[chunk];
+	for (int k0=0; k0<M; k0+=chunk) {
+		const int L = M-k0 < chunk ? M-k0 : chunk;
+		for (int k=0; k<L; ++k) {
+			rho[k] = -2.0 * log_kernel(u1[k0+k]);
+		}
+		for (int k=0; k<L; ++k) {
+			rho[k] = std::sqrt(rho[k]);
+		}
+		for (int k=0; k<L; ++k) {
+			double c, s;
+			sincos_kernel(u2[k0+k], c, s);
+			z0[k0+k] = rho[k] * c;
+			z1[k0+k] = rho[k] * s;
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
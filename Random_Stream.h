@@ -27,6 +27,8 @@
 /*                                       Random number streams                                      */
 /****************************************************************************************************/
 #pragma once
+#include <cmath>
+#include <cstdint>
 #include <random>
 
 /****************************************************************************************************/
@@ -78,3 +80,155 @@ struct random_stream_uniform_int
 /****************************************************************************************************/
 /*										 		end													*/
 /****************************************************************************************************/
+
+/****************************************************************************************************/
+/*                          Counter-based generator Philox4x32-10                                   */
+/*      J. K. Salmon, M. A. Moraes, R. O. Dror, D. E. Shaw. Parallel random numbers: as easy as     */
+/*      1, 2, 3. Proceedings of SC'11 (2011)                                                        */
+/*                                                                                                  */
+/*      The output is a pure function of a 128 bit counter and a 64 bit key. There is no state      */
+/*      besides the counter, so any position of any stream can be computed in O(1) and streams      */
+/*      can be created concurrently without any shared seeding.                                     */
+/****************************************************************************************************/
+struct philox4x32
+{
+    /* Applies the 10 rounds of the bijection to the counter (c0, c1, c2, c3) */
+    static void generate(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1) {
+        for (int i=0; i<10; ++i) {
+            const uint64_t p0 = (uint64_t) 0xD2511F53u * c0;
+            const uint64_t p1 = (uint64_t) 0xCD9E8D57u * c2;
+            const uint32_t o1 = c1, o3 = c3;
+            c0 = (uint32_t) (p1 >> 32) ^ o1 ^ k0;
+            c1 = (uint32_t)  p1;
+            c2 = (uint32_t) (p0 >> 32) ^ o3 ^ k1;
+            c3 = (uint32_t)  p0;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+    }
+};
+/****************************************************************************************************/
+/*										 		end													*/
+/****************************************************************************************************/
+
+/****************************************************************************************************/
+/*                          Identifiers of the columns within the RNG key                           */
+/****************************************************************************************************/
+enum RNG_Column {
+    RNG_CORTEX  = 0,
+    RNG_CA3     = 1
+};
+/****************************************************************************************************/
+/*										 		end													*/
+/****************************************************************************************************/
+
+/****************************************************************************************************/
+/*                          Block kernels of the counter-based streams                              */
+/*      Both work on whole arrays and are compiled for AVX-512, AVX2 and baseline x86-64, the       */
+/*      variant is selected at load time. Single draws use the same kernels with M = 1, so the      */
+/*      results do not depend on the block size. See Random_Stream.cpp.                             */
+/****************************************************************************************************/
+/* Uniforms u1 in (0, 1] and u2 in [0, 1) of the counters (n + k*dn, r + k*dr, stream), 0 <= k < M  */
+void philox_uniforms (uint64_t seed, uint64_t n, uint64_t dn, uint32_t r, uint32_t dr, uint32_t stream,
+                      int M, double* u1, double* u2);
+
+/* Box-Muller transform of M uniform pairs to standard normals, may be done in place                */
+void box_muller (const double* u1, const double* u2, double* z0, double* z1, int M);
+/****************************************************************************************************/
+/*										 		end													*/
+/****************************************************************************************************/
+
+/****************************************************************************************************/
+/*                          Struct for counter-based normal distribution                            */
+/*      Every stream is identified by (seed, realization, column, stream index). The n-th draw      */
+/*      uses the counter (n/2, realization, column << 16 | stream) with the seed as key. The four    */
+/*      32 bit outputs form two 52 bit uniforms that are mapped to two normals via Box-Muller.      */
+/****************************************************************************************************/
+struct random_stream_philox
+{
+    /* Key of the stream */
+    uint64_t    seed        = 0;
+    uint32_t    realization = 0;
+    uint32_t    stream      = 0;
+    /* Index of the next draw */
+    uint64_t    position    = 0;
+    /* Parameters of the normal distribution */
+    double      mean        = 0.0;
+    double      stddev      = 1.0;
+    /* Second normal of the last evaluated counter */
+    uint64_t    cached      = UINT64_MAX;
+    double      spare       = 0.0;
+
+    /* Constructors */
+    random_stream_philox(){}
+    random_stream_philox(double mean, double stddev, uint64_t seed, uint32_t realization,
+                         RNG_Column column, uint32_t index)
+    : seed(seed), realization(realization), stream((uint32_t) column << 16 | index),
+      mean(mean), stddev(stddev)
+    {}
+
+    /* Skip ahead by n draws or jump to an absolute draw index */
+    void skip (uint64_t n) {position += n;}
+    void seek (uint64_t n) {position  = n;}
+
+    /* Standard normal pair of the counter value n */
+    void normal_pair (uint64_t n, double& z0, double& z1) const {
+        philox_uniforms(seed, n, 1, realization, 0, stream, 1, &z0, &z1);
+        box_muller(&z0, &z1, &z0, &z1, 1);
+    }
+
+    /* Standard normal pairs of the counter value n for the realizations [0, R) of a stream */
+    static void normal_pairs (uint64_t n, uint64_t seed, RNG_Column column, uint32_t index,
+                              int R, double* z0, double* z1) {
+        philox_uniforms(seed, n, 0, 0, 1, (uint32_t) column << 16 | index, R, z0, z1);
+        box_muller(z0, z1, z0, z1, R);
+    }
+
+    /* Writes the next count draws to out, identical to count calls of operator() */
+    void fill (double* out, int count) {
+        /* Complete a started pair */
+        if ((position & 1) && count > 0) {
+            *out++ = (*this)();
+            --count;
+        }
+
+        /* Whole pairs in chunks, first all uniforms then all transforms */
+        const int   chunk = 128;
+        double      u1[chunk], u2[chunk];
+        while (count >= 2) {
+            const int       M = count/2 < chunk ? count/2 : chunk;
+            philox_uniforms(seed, position >> 1, 1, realization, 0, stream, M, u1, u2);
+            box_muller(u1, u2, u1, u2, M);
+            for (int k=0; k<M; ++k) {
+                out[2*k]   = mean + stddev * u1[k];
+                out[2*k+1] = mean + stddev * u2[k];
+            }
+            position += 2*M;
+            out      += 2*M;
+            count    -= 2*M;
+        }
+
+        /* Remaining single draw */
+        if (count > 0) {
+            *out = (*this)();
+        }
+    }
+
+    /* Overwrites the function-call operator "( )" */
+    double operator( )(void) {
+        double z;
+        if ((position & 1) && cached == position >> 1) {
+            z = spare;
+        } else {
+            double z0;
+            cached = position >> 1;
+            normal_pair(cached, z0, spare);
+            z = (position & 1) ? spare : z0;
+        }
+        ++position;
+        return mean + stddev * z;
+    }
+};
+/****************************************************************************************************/
+/*										 		end													*/
+/****************************************************************************************************/
@@ -0,0 +1,90 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Combination of the SRK4 moments										*/
+/*																									*/
+/*		Shared by all ensembles. The moments of a variable are stored in one array of length 5*R,	*/
+/*		the kth moment of realization r at [k*R + r], and the new state replaces moment 0.		*/
+/****************************************************************************************************/
+#pragma once
+#include <cmath>
+#include <limits>
+
+/* Combines the moments of a noise free variable */
+template <typename T>
+inline void add_moments(T* __restrict__ x, int R) {
+	for (int r=0; r<R; ++r) {
+		x[r] = (-3*x[r] + 2*x[R+r] + 4*x[2*R+r] + 2*x[3*R+r] + x[4*R+r])/6;
+	}
+}
+
+/* Combines the moments of a noisy variable */
+template <typename T>
+inline void add_moments(T* __restrict__ x, const T* __restrict__ n1,
+							   const T* __restrict__ n2, T g2, int R) {
+	const T s3	= std::sqrt(T(3));
+	for (int r=0; r<R; ++r) {
+		x[r] = (-3*x[r] + 2*x[R+r] + 4*x[2*R+r] + 2*x[3*R+r] + x[4*R+r])/6 + g2 * (n1[r] - n2[r]*s3)/4;
+	}
+}
+
+/* Mixed precision, the increment is formed from differences of the moments in T and added to the	*/
+/* state accumulated in S, which is then rounded to the initial moment. A state decaying to 0 is	*/
+/* flushed once it leaves the normal range of T, as subnormal moments slow down every stage.		*/
+/* The rounding is a separate pass, so GCC vectorizes both loops									*/
+template <typename T, typename S>
+inline void add_moments(T* __restrict__ x, S* __restrict__ acc, int R) {
+	const S lower = std::numeric_limits<T>::min();
+	for (int r=0; r<R; ++r) {
+		const S y = acc[r] + (2*(x[R+r] - x[r]) + 4*(x[2*R+r] - x[r]) + 2*(x[3*R+r] - x[r]) + (x[4*R+r] - x[r]))/6;
+		acc[r]	= std::abs(y) >= lower ? y : S(0);
+	}
+	for (int r=0; r<R; ++r) {
+		x[r]	= T(acc[r]);
+	}
+}
+
+template <typename T, typename S>
+inline void add_moments(T* __restrict__ x, S* __restrict__ acc, const T* __restrict__ n1,
+							   const T* __restrict__ n2, T g2, int R) {
+	const T s3		= std::sqrt(T(3));
+	const S lower	= std::numeric_limits<T>::min();
+	for (int r=0; r<R; ++r) {
+		const S y = acc[r] + ((2*(x[R+r] - x[r]) + 4*(x[2*R+r] - x[r]) + 2*(x[3*R+r] - x[r]) + (x[4*R+r] - x[r]))/6
+							  + g2 * (n1[r] - n2[r]*s3)/4);
+		acc[r]	= std::abs(y) >= lower ? y : S(0);
+	}
+	for (int r=0; r<R; ++r) {
+		x[r]	= T(acc[r]);
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,320 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Implementation of sharded sweeps								*/
+/****************************************************************************************************/
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Shard.h"
+
+/****************************************************************************************************/
+/*										 	Socket transfer 										*/
+/****************************************************************************************************/
+/* Complete reads and writes, false on error or end of file. Writing to a closed socket fails	*/
+/* with EPIPE instead of raising SIGPIPE, in the coordinator as well as in the workers			*/
+static bool send_all(int fd, const void* data, size_t size) {
+	const char* p = static_cast<const char*>(data);
+	while (size > 0) {
+		const ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p	 += n;
+		size -= n;
+	}
+	return true;
+}
+
+static bool receive_all(int fd, void* data, size_t size) {
+	char* p = static_cast<char*>(data);
+	while (size > 0) {
+		const ssize_t n = ::read(fd, p, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p	 += n;
+		size -= n;
+	}
+	return true;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Serialization of results 									*/
+/****************************************************************************************************/
+template <typename T>
+static void put(std::string& out, const T& x) {
+	out.append(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+
+template <typename T>
+static void get(const std::string& in, size_t& pos, T& x) {
+	if (pos + sizeof(T) > in.size()) {
+		throw std::runtime_error("run_sharded: truncated result");
+	}
+	std::memcpy(&x, in.data() + pos, sizeof(T));
+	pos += sizeof(T);
+}
+
+static std::string pack(const Sweep_Result& r) {
+	std::string out;
+	put(out, r.point);
+	put(out, r.realization);
+	for (int c=0; c<3; ++c) {
+		put(out, r.mean[c]);
+		put(out, r.std [c]);
+	}
+	for (int c=0; c<3; ++c) {
+		put(out, (uint32_t) r.psd[c].size());
+		for (double p : r.psd[c]) {
+			put(out, p);
+		}
+	}
+	put(out, (uint32_t) r.events.size());
+	for (const HFO_Event& e : r.events) {
+		put(out, e);
+	}
+	return out;
+}
+
+static Sweep_Result unpack(const std::string& in) {
+	Sweep_Result r;
+	size_t		 pos = 0;
+	uint32_t	 n;
+	get(in, pos, r.point);
+	get(in, pos, r.realization);
+	for (int c=0; c<3; ++c) {
+		get(in, pos, r.mean[c]);
+		get(in, pos, r.std [c]);
+	}
+	for (int c=0; c<3; ++c) {
+		get(in, pos, n);
+		r.psd[c].resize(n);
+		for (double& p : r.psd[c]) {
+			get(in, pos, p);
+		}
+	}
+	get(in, pos, n);
+	r.events.resize(n);
+	for (HFO_Event& e : r.events) {
+		get(in, pos, e);
+	}
+	return r;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Worker process 											*/
+/****************************************************************************************************/
+/* Loop of a worker, never returns. A failing job ends the worker, so the exception never		*/
+/* unwinds into the code of the parent that called run_sharded									*/
+static void work(const Sweep& sweep, int T, int onset, int fd) {
+	std::string result;
+	for (;;) {
+		const uint32_t length = result.size();
+		int32_t job;
+		if (!send_all(fd, &length, sizeof(length)) || !send_all(fd, result.data(), length) ||
+			!receive_all(fd, &job, sizeof(job)) || job < 0) {
+			break;
+		}
+		try {
+			result = pack(sweep.run_job(job, T, onset));
+		} catch (const std::exception& e) {
+			fprintf(stderr, "run_sharded: job %d failed: %s\n", job, e.what());
+			_exit(1);
+		} catch (...) {
+			_exit(1);
+		}
+	}
+	close(fd);
+	_exit(0);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Coordinator 											*/
+/****************************************************************************************************/
+vector<Sweep_Result> run_sharded(const Sweep& sweep, int T, int onset, int workers) {
+	/* Every worker has a socket and the job it is working on, -1 if none. Idle workers have		*/
+	/* asked for a job while there was none left													*/
+	struct Worker {
+		pid_t	pid;
+		int		fd;
+		int		job;
+		bool	idle;
+	};
+	vector<Worker> pool;
+	for (int i=0; i<workers; ++i) {
+		int fds[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) {
+			break;
+		}
+		const pid_t pid = fork();
+		if (pid == 0) {
+			/* The worker only keeps its own end of the socket */
+			close(fds[0]);
+			for (const Worker& w : pool) {
+				close(w.fd);
+			}
+			work(sweep, T, onset, fds[1]);
+		}
+		close(fds[1]);
+		if (pid < 0) {
+			close(fds[0]);
+			break;
+		}
+		pool.push_back(Worker{pid, fds[0], -1, false});
+	}
+	if (pool.empty()) {
+		throw std::runtime_error("run_sharded: cannot start a worker");
+	}
+
+	std::deque<int>			pending;
+	vector<Sweep_Result>	results(sweep.jobs());
+	for (int job=0; job<sweep.jobs(); ++job) {
+		pending.push_back(job);
+	}
+	int done = 0, alive = pool.size();
+
+	/* Answer every message with the next job, jobs of lost workers are queued again */
+	while (done < sweep.jobs() && alive > 0) {
+		for (Worker& w : pool) {
+			if (w.fd >= 0 && w.idle && !pending.empty()) {
+				w.job  = pending.front();
+				w.idle = false;
+				pending.pop_front();
+				if (!send_all(w.fd, &w.job, sizeof(int32_t))) {
+					pending.push_front(w.job);
+					close(w.fd);
+					w.fd  = -1;
+					w.job = -1;
+					--alive;
+				}
+			}
+		}
+		if (alive == 0) {
+			break;
+		}
+
+		vector<pollfd> fds;
+		vector<int>	   index;
+		for (unsigned i=0; i<pool.size(); ++i) {
+			if (pool[i].fd >= 0) {
+				fds.push_back(pollfd{pool[i].fd, POLLIN, 0});
+				index.push_back(i);
+			}
+		}
+		if (poll(fds.data(), fds.size(), -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		for (unsigned k=0; k<fds.size(); ++k) {
+			if (!fds[k].revents) {
+				continue;
+			}
+			Worker&		w = pool[index[k]];
+			uint32_t	length;
+			std::string message;
+			bool		ok = receive_all(w.fd, &length, sizeof(length));
+			if (ok) {
+				message.resize(length);
+				ok = receive_all(w.fd, &message[0], length);
+			}
+			if (ok && length > 0) {
+				try {
+					results[w.job] = unpack(message);
+					++done;
+					w.job = -1;
+				} catch (const std::runtime_error&) {
+					ok = false;
+				}
+			}
+			if (ok && !pending.empty()) {
+				w.job = pending.front();
+				pending.pop_front();
+				ok = send_all(w.fd, &w.job, sizeof(int32_t));
+			} else if (ok) {
+				w.idle = true;
+			}
+			if (!ok) {
+				if (w.job >= 0) {
+					pending.push_front(w.job);
+				}
+				close(w.fd);
+				w.fd  = -1;
+				w.job = -1;
+				--alive;
+			}
+		}
+	}
+
+	/* Stop the workers */
+	for (Worker& w : pool) {
+		if (w.fd >= 0) {
+			const int32_t stop = -1;
+			send_all(w.fd, &stop, sizeof(stop));
+			close(w.fd);
+		}
+		waitpid(w.pid, nullptr, 0);
+	}
+	if (done < sweep.jobs()) {
+		throw std::runtime_error("run_sharded: all workers died");
+	}
+	return results;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,52 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Sharded parameter sweeps									*/
+/*																									*/
+/*		The coordinator forks a number of worker processes, each connected by a local socket		*/
+/*		pair. Workers ask for work by sending their last result, the coordinator answers with		*/
+/*		the next job index, so fast workers simply take more jobs. Jobs of a worker that dies		*/
+/*		are given to the remaining workers. The results are merged in job order, so the output		*/
+/*		is identical to Sweep::run.																	*/
+/*																									*/
+/*		Messages:	coordinator -> worker	int32 job, -1 to stop										*/
+/*					worker -> coordinator	uint32 length, result (length bytes, length 0 if idle)	*/
+/****************************************************************************************************/
+#pragma once
+#include <vector>
+#include "Sweep.h"
+using std::vector;
+
+/* Run all jobs of a sweep on the given number of worker processes, throws std::runtime_error	*/
+/* if no worker can be started or all workers died before the sweep was done					*/
+vector<Sweep_Result> run_sharded (const Sweep& sweep, int T, int onset, int workers);
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
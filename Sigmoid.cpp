@@ -0,0 +1,328 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Implementation of the sigmoid kernels								*/
+/****************************************************************************************************/
+#include "Profiler.h"
+#include "Sigmoid.h"
+#if defined(__GNUC__) && defined(__x86_64__)
+/* GCC 12 reports false positives for the undefined pass-through operands of the AVX-512 intrinsics */
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#define SIGMOID_X86
+#endif
+
+/****************************************************************************************************/
+/*										Kernel selection											*/
+/****************************************************************************************************/
+typedef void (*sigmoid_kernel)(double, const double*, double*, int);
+typedef void (*sigmoid_kernel_f)(float, const float*, float*, int);
+
+static void sigmoid_libm	(double Q_max, const double* u, double* Q, int R);
+static void sigmoid_scalar	(double Q_max, const double* u, double* Q, int R);
+#ifdef SIGMOID_X86
+static void sigmoid_avx2	(double Q_max, const double* u, double* Q, int R);
+static void sigmoid_avx512	(double Q_max, const double* u, double* Q, int R);
+#endif
+static void sigmoidf_libm	(float Q_max, const float* u, float* Q, int R);
+static void sigmoidf_scalar	(float Q_max, const float* u, float* Q, int R);
+#ifdef SIGMOID_X86
+static void sigmoidf_avx2	(float Q_max, const float* u, float* Q, int R);
+static void sigmoidf_avx512	(float Q_max, const float* u, float* Q, int R);
+#endif
+
+static Sigmoid_Mode		active_mode		= SIGMOID_LIBM;
+static sigmoid_kernel	active_kernel	= sigmoid_libm;
+static sigmoid_kernel_f	active_kernel_f	= sigmoidf_libm;
+bool					sigmoid_fast	= false;
+
+Sigmoid_Mode set_sigmoid_mode(Sigmoid_Mode mode) {
+#ifdef SIGMOID_X86
+	const bool has_avx512	= __builtin_cpu_supports("avx512f");
+	const bool has_avx2		= __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	const bool has_avx512	= false;
+	const bool has_avx2		= false;
+#endif
+	/* Resolve to the widest supported kernel not wider than the requested one */
+	if (mode == SIGMOID_AUTO) {
+		mode = SIGMOID_AVX512;
+	}
+	if (mode == SIGMOID_AVX512 && !has_avx512) {
+		mode = SIGMOID_AVX2;
+	}
+	if (mode == SIGMOID_AVX2 && !has_avx2) {
+		mode = SIGMOID_SCALAR;
+	}
+
+	switch (mode) {
+#ifdef SIGMOID_X86
+	case SIGMOID_AVX512:	active_kernel = sigmoid_avx512;	active_kernel_f = sigmoidf_avx512;	break;
+	case SIGMOID_AVX2:		active_kernel = sigmoid_avx2;	active_kernel_f = sigmoidf_avx2;	break;
+#endif
+	case SIGMOID_SCALAR:	active_kernel = sigmoid_scalar;	active_kernel_f = sigmoidf_scalar;	break;
+	default:				active_kernel = sigmoid_libm;	active_kernel_f = sigmoidf_libm;
+							mode = SIGMOID_LIBM;			break;
+	}
+	active_mode  = mode;
+	sigmoid_fast = mode != SIGMOID_LIBM;
+	return mode;
+}
+
+Sigmoid_Mode get_sigmoid_mode(void) {
+	return active_mode;
+}
+
+const char* sigmoid_mode_name(Sigmoid_Mode mode) {
+	switch (mode) {
+	case SIGMOID_LIBM:		return "libm";
+	case SIGMOID_SCALAR:	return "scalar";
+	case SIGMOID_AVX2:		return "avx2";
+	case SIGMOID_AVX512:	return "avx512";
+	default:				return "auto";
+	}
+}
+
+void sigmoid(double Q_max, const double* u, double* Q, int R) {
+	PROFILE_SCOPE(PROFILE_SIGMOID);
+	active_kernel(Q_max, u, Q, R);
+}
+
+void sigmoid(float Q_max, const float* u, float* Q, int R) {
+	PROFILE_SCOPE(PROFILE_SIGMOID);
+	active_kernel_f(Q_max, u, Q, R);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Scalar kernels												*/
+/****************************************************************************************************/
+static void sigmoid_libm(double Q_max, const double* u, double* Q, int R) {
+	for (int r=0; r<R; ++r) {
+		Q[r] = Q_max / (1 + exp(-u[r]));
+	}
+}
+
+static void sigmoid_scalar(double Q_max, const double* u, double* Q, int R) {
+	for (int r=0; r<R; ++r) {
+		Q[r] = Q_max / (1 + fast_exp(-u[r]));
+	}
+}
+
+static void sigmoidf_libm(float Q_max, const float* u, float* Q, int R) {
+	for (int r=0; r<R; ++r) {
+		Q[r] = Q_max / (1 + std::exp(-u[r]));
+	}
+}
+
+static void sigmoidf_scalar(float Q_max, const float* u, float* Q, int R) {
+	for (int r=0; r<R; ++r) {
+		Q[r] = Q_max / (1 + fast_expf(-u[r]));
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+#ifdef SIGMOID_X86
+/****************************************************************************************************/
+/*										AVX2 kernel													*/
+/****************************************************************************************************/
+__attribute__((target("avx2,fma")))
+static inline __m256d fast_exp_avx2(__m256d x) {
+	using namespace fast_exp_constants;
+	x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(lower)), _mm256_set1_pd(upper));
+
+	/* Range reduction */
+	const __m256d t	= _mm256_fmadd_pd(x, _mm256_set1_pd(log2e), _mm256_set1_pd(shift));
+	const __m256d k	= _mm256_sub_pd(t, _mm256_set1_pd(shift));
+	__m256d r		= _mm256_fnmadd_pd(k, _mm256_set1_pd(ln2_hi), x);
+	r				= _mm256_fnmadd_pd(k, _mm256_set1_pd(ln2_lo), r);
+
+	/* Polynomial approximation of exp(r) */
+	__m256d p = _mm256_set1_pd(c[12]);
+	for (int n=11; n>=0; --n) {
+		p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(c[n]));
+	}
+
+	/* Scaling by 2^k */
+	__m256i bits = _mm256_sub_epi64(_mm256_castpd_si256(t), _mm256_set1_epi64x(0x4338000000000000LL));
+	bits = _mm256_slli_epi64(_mm256_add_epi64(bits, _mm256_set1_epi64x(1023)), 52);
+	return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+}
+
+__attribute__((target("avx2,fma")))
+static void sigmoid_avx2(double Q_max, const double* u, double* Q, int R) {
+	const __m256d q		= _mm256_set1_pd(Q_max);
+	const __m256d one	= _mm256_set1_pd(1.0);
+	const __m256d zero	= _mm256_setzero_pd();
+	int r = 0;
+	for (; r+4<=R; r+=4) {
+		const __m256d e = fast_exp_avx2(_mm256_sub_pd(zero, _mm256_loadu_pd(u+r)));
+		_mm256_storeu_pd(Q+r, _mm256_div_pd(q, _mm256_add_pd(one, e)));
+	}
+	sigmoid_scalar(Q_max, u+r, Q+r, R-r);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										AVX-512 kernel												*/
+/****************************************************************************************************/
+__attribute__((target("avx512f")))
+static inline __m512d fast_exp_avx512(__m512d x) {
+	using namespace fast_exp_constants;
+	x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(lower)), _mm512_set1_pd(upper));
+
+	/* Range reduction */
+	const __m512d k	= _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(log2e)),
+										   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m512d r		= _mm512_fnmadd_pd(k, _mm512_set1_pd(ln2_hi), x);
+	r				= _mm512_fnmadd_pd(k, _mm512_set1_pd(ln2_lo), r);
+
+	/* Polynomial approximation of exp(r) */
+	__m512d p = _mm512_set1_pd(c[12]);
+	for (int n=11; n>=0; --n) {
+		p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(c[n]));
+	}
+
+	/* Scaling by 2^k */
+	return _mm512_scalef_pd(p, k);
+}
+
+__attribute__((target("avx512f")))
+static void sigmoid_avx512(double Q_max, const double* u, double* Q, int R) {
+	const __m512d q		= _mm512_set1_pd(Q_max);
+	const __m512d one	= _mm512_set1_pd(1.0);
+	const __m512d zero	= _mm512_setzero_pd();
+	int r = 0;
+	for (; r+8<=R; r+=8) {
+		const __m512d e = fast_exp_avx512(_mm512_sub_pd(zero, _mm512_loadu_pd(u+r)));
+		_mm512_storeu_pd(Q+r, _mm512_div_pd(q, _mm512_add_pd(one, e)));
+	}
+	/* Remaining realizations are handled with a masked load/store */
+	if (r < R) {
+		const __mmask8 m	= (__mmask8)((1u << (R-r)) - 1);
+		const __m512d e		= fast_exp_avx512(_mm512_sub_pd(zero, _mm512_maskz_loadu_pd(m, u+r)));
+		_mm512_mask_storeu_pd(Q+r, m, _mm512_div_pd(q, _mm512_add_pd(one, e)));
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Single precision kernels										*/
+/****************************************************************************************************/
+__attribute__((target("avx2,fma")))
+static inline __m256 fast_expf_avx2(__m256 x) {
+	using namespace fast_expf_constants;
+	x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(lower)), _mm256_set1_ps(upper));
+
+	/* Range reduction */
+	const __m256 t	= _mm256_fmadd_ps(x, _mm256_set1_ps(log2e), _mm256_set1_ps(shift));
+	const __m256 k	= _mm256_sub_ps(t, _mm256_set1_ps(shift));
+	__m256 r		= _mm256_fnmadd_ps(k, _mm256_set1_ps(ln2_hi), x);
+	r				= _mm256_fnmadd_ps(k, _mm256_set1_ps(ln2_lo), r);
+
+	/* Polynomial approximation of exp(r) */
+	__m256 p = _mm256_set1_ps(c[7]);
+	for (int n=6; n>=0; --n) {
+		p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(c[n]));
+	}
+
+	/* Scaling by 2^k */
+	__m256i bits = _mm256_sub_epi32(_mm256_castps_si256(t), _mm256_set1_epi32(0x4B400000));
+	bits = _mm256_slli_epi32(_mm256_add_epi32(bits, _mm256_set1_epi32(127)), 23);
+	return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+}
+
+__attribute__((target("avx2,fma")))
+static void sigmoidf_avx2(float Q_max, const float* u, float* Q, int R) {
+	const __m256 q		= _mm256_set1_ps(Q_max);
+	const __m256 one	= _mm256_set1_ps(1.0f);
+	const __m256 zero	= _mm256_setzero_ps();
+	int r = 0;
+	for (; r+8<=R; r+=8) {
+		const __m256 e = fast_expf_avx2(_mm256_sub_ps(zero, _mm256_loadu_ps(u+r)));
+		_mm256_storeu_ps(Q+r, _mm256_div_ps(q, _mm256_add_ps(one, e)));
+	}
+	sigmoidf_scalar(Q_max, u+r, Q+r, R-r);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 fast_expf_avx512(__m512 x) {
+	using namespace fast_expf_constants;
+	x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(lower)), _mm512_set1_ps(upper));
+
+	/* Range reduction */
+	const __m512 k	= _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(log2e)),
+										   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m512 r		= _mm512_fnmadd_ps(k, _mm512_set1_ps(ln2_hi), x);
+	r				= _mm512_fnmadd_ps(k, _mm512_set1_ps(ln2_lo), r);
+
+	/* Polynomial approximation of exp(r) */
+	__m512 p = _mm512_set1_ps(c[7]);
+	for (int n=6; n>=0; --n) {
+		p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(c[n]));
+	}
+
+	/* Scaling by 2^k */
+	return _mm512_scalef_ps(p, k);
+}
+
+__attribute__((target("avx512f")))
+static void sigmoidf_avx512(float Q_max, const float* u, float* Q, int R) {
+	const __m512 q		= _mm512_set1_ps(Q_max);
+	const __m512 one	= _mm512_set1_ps(1.0f);
+	const __m512 zero	= _mm512_setzero_ps();
+	int r = 0;
+	for (; r+16<=R; r+=16) {
+		const __m512 e = fast_expf_avx512(_mm512_sub_ps(zero, _mm512_loadu_ps(u+r)));
+		_mm512_storeu_ps(Q+r, _mm512_div_ps(q, _mm512_add_ps(one, e)));
+	}
+	/* Remaining realizations are handled with a masked load/store */
+	if (r < R) {
+		const __mmask16 m	= (__mmask16)((1u << (R-r)) - 1);
+		const __m512 e		= fast_expf_avx512(_mm512_sub_ps(zero, _mm512_maskz_loadu_ps(m, u+r)));
+		_mm512_mask_storeu_ps(Q+r, m, _mm512_div_ps(q, _mm512_add_ps(one, e)));
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+#endif
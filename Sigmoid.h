@@ -0,0 +1,174 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Sigmoidal firing rate kernels										*/
+/*																									*/
+/*		All firing rates of the model are of the form Q = Q_max / (1 + exp(-u)). The reference		*/
+/*		path uses the exp of libm. The fast paths use a range reduced polynomial exp:				*/
+/*			exp(x) = 2^k * exp(r),	k = round(x/ln2),	|r| <= ln2/2								*/
+/*		where exp(r) is the Taylor polynomial of degree 12 evaluated by Horner's scheme. The		*/
+/*		truncation error is below 1.8E-16. The measured maximum relative error over [-708, 709]		*/
+/*		is below 5E-16 (about 2 ulp) for fast_exp and the resulting firing rates of all kernels.	*/
+/*		Arguments outside that interval are clamped, which is irrelevant for the sigmoid as			*/
+/*		Q_max/(1 + exp(x)) is then 0 or Q_max to double precision.									*/
+/****************************************************************************************************/
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/****************************************************************************************************/
+/*										Available kernels											*/
+/****************************************************************************************************/
+enum Sigmoid_Mode {
+	SIGMOID_LIBM,			/* reference, exp of libm						*/
+	SIGMOID_SCALAR,			/* fast_exp, one value at a time				*/
+	SIGMOID_AVX2,			/* fast_exp, 4 values at a time					*/
+	SIGMOID_AVX512,			/* fast_exp, 8 values at a time					*/
+	SIGMOID_AUTO			/* widest fast kernel supported by the CPU		*/
+};
+
+/* Selects the kernel, falls back to narrower ones if the CPU lacks support. Returns the kernel used */
+Sigmoid_Mode	set_sigmoid_mode	(Sigmoid_Mode mode);
+Sigmoid_Mode	get_sigmoid_mode	(void);
+const char*		sigmoid_mode_name	(Sigmoid_Mode mode);
+
+/* Q[r] = Q_max / (1 + exp(-u[r])) for 0 <= r < R, u and Q may alias */
+void			sigmoid				(double Q_max, const double* u, double* Q, int R);
+
+/* Single precision version with the same kernel selection, the fast kernels use fast_expf */
+void			sigmoid				(float Q_max, const float* u, float* Q, int R);
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Scalar fast exponential										*/
+/****************************************************************************************************/
+namespace fast_exp_constants {
+	const double	lower	= -708.0;
+	const double	upper	=  709.0;
+	const double	log2e	= 1.4426950408889634074;
+	const double	ln2_hi	= 6.93147180369123816490E-1;
+	const double	ln2_lo	= 1.90821492927058770002E-10;
+	/* Adding 1.5*2^52 rounds to the nearest integer, which is then found in the low mantissa bits */
+	const double	shift	= 6755399441055744.0;
+	/* Taylor coefficients 1/n! for n = 0,...,12 */
+	const double	c[13]	= {1.0, 1.0, 1.0/2, 1.0/6, 1.0/24, 1.0/120, 1.0/720, 1.0/5040,
+							   1.0/40320, 1.0/362880, 1.0/3628800, 1.0/39916800, 1.0/479001600};
+}
+
+inline double fast_exp(double x) {
+	using namespace fast_exp_constants;
+	x = x < lower ? lower : (x > upper ? upper : x);
+
+	/* Range reduction */
+	const double t	= x * log2e + shift;
+	const double k	= t - shift;
+	double r		= x - k * ln2_hi;
+	r				= r - k * ln2_lo;
+
+	/* Polynomial approximation of exp(r) */
+	double p = c[12];
+	for (int n=11; n>=0; --n) {
+		p = p * r + c[n];
+	}
+
+	/* Scaling by 2^k */
+	int64_t bits;
+	std::memcpy(&bits, &t, sizeof(bits));
+	bits = (bits - INT64_C(0x4338000000000000) + 1023) << 52;
+	double scale;
+	std::memcpy(&scale, &bits, sizeof(scale));
+	return p * scale;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Scalar fast exponential, float									*/
+/*		Same scheme as fast_exp with the Taylor polynomial of degree 7, the truncation error is		*/
+/*		below 1E-8, so the result is within about 1 ulp of single precision on [-87, 88].			*/
+/****************************************************************************************************/
+namespace fast_expf_constants {
+	const float		lower	= -87.0f;
+	const float		upper	=  88.0f;
+	const float		log2e	= 1.44269504f;
+	const float		ln2_hi	= 6.93145752E-1f;
+	const float		ln2_lo	= 1.42860677E-6f;
+	/* Adding 1.5*2^23 rounds to the nearest integer, which is then found in the low mantissa bits */
+	const float		shift	= 12582912.0f;
+	/* Taylor coefficients 1/n! for n = 0,...,7 */
+	const float		c[8]	= {1.0f, 1.0f, 1.0f/2, 1.0f/6, 1.0f/24, 1.0f/120, 1.0f/720, 1.0f/5040};
+}
+
+inline float fast_expf(float x) {
+	using namespace fast_expf_constants;
+	x = x < lower ? lower : (x > upper ? upper : x);
+
+	/* Range reduction */
+	const float t	= x * log2e + shift;
+	const float k	= t - shift;
+	float r			= x - k * ln2_hi;
+	r				= r - k * ln2_lo;
+
+	/* Polynomial approximation of exp(r) */
+	float p = c[7];
+	for (int n=6; n>=0; --n) {
+		p = p * r + c[n];
+	}
+
+	/* Scaling by 2^k */
+	int32_t bits;
+	std::memcpy(&bits, &t, sizeof(bits));
+	bits = (bits - 0x4B400000 + 127) << 23;
+	float scale;
+	std::memcpy(&scale, &bits, sizeof(scale));
+	return p * scale;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*								Scalar sigmoid used by the columns									*/
+/****************************************************************************************************/
+extern bool sigmoid_fast;
+
+inline double sigmoid(double Q_max, double u) {
+	return Q_max / (1 + (sigmoid_fast ? fast_exp(-u) : exp(-u)));
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,107 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Binary state snapshots										*/
+/*																									*/
+/*		A snapshot holds everything a column needs to continue bit-identically: the state at the	*/
+/*		start of the next step, the current noise, the variable parameters and the key and			*/
+/*		position of every noise stream. The pre-generated noise block is not stored, it is			*/
+/*		regenerated from the stream positions on load. All values are in native byte order.		*/
+/*																									*/
+/*		Layout:	char[8] magic "NMHFOSNP", uint32 version, uint32 column (RNG_Column), uint64 seed,	*/
+/*				uint32 realization, uint32 number of streams S, S times uint64 position, fields		*/
+/****************************************************************************************************/
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+static const char		snapshot_magic[8]	= {'N', 'M', 'H', 'F', 'O', 'S', 'N', 'P'};
+static const uint32_t	snapshot_version	= 1;
+
+/****************************************************************************************************/
+/*										Archives of plain values									*/
+/****************************************************************************************************/
+struct Snapshot_Writer {
+	std::ostream& out;
+
+	template <typename T>
+	void operator() (const T& x) {
+		out.write(reinterpret_cast<const char*>(&x), sizeof(T));
+	}
+};
+
+struct Snapshot_Reader {
+	std::istream& in;
+
+	template <typename T>
+	void operator() (T& x) {
+		if (!in.read(reinterpret_cast<char*>(&x), sizeof(T))) {
+			throw std::runtime_error("snapshot is truncated");
+		}
+	}
+};
+
+/* Header of a snapshot */
+inline void write_snapshot_header(Snapshot_Writer& ar, uint32_t column, uint64_t seed, uint32_t realization,
+								  uint32_t streams) {
+	ar.out.write(snapshot_magic, sizeof(snapshot_magic));
+	ar(snapshot_version);
+	ar(column);
+	ar(seed);
+	ar(realization);
+	ar(streams);
+}
+
+/* Checks the header of a snapshot against the column and number of streams */
+inline void read_snapshot_header(Snapshot_Reader& ar, uint32_t column, uint64_t& seed, uint32_t& realization,
+								 uint32_t streams) {
+	char		magic[8];
+	uint32_t	version, kind, count;
+	if (!ar.in.read(magic, sizeof(magic)) || std::memcmp(magic, snapshot_magic, sizeof(magic))) {
+		throw std::runtime_error("no snapshot");
+	}
+	ar(version);
+	ar(kind);
+	ar(seed);
+	ar(realization);
+	ar(count);
+	if (version != snapshot_version) {
+		throw std::runtime_error("unsupported snapshot version");
+	}
+	if (kind != column || count != streams) {
+		throw std::runtime_error("snapshot belongs to a different column type");
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,337 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Functions of parameter sweeps									*/
+/****************************************************************************************************/
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include "Data_Storage.h"
+#include "ODE.h"
+#include "Sweep.h"
+#include "Thread_Pool.h"
+#include "Welch.h"
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+Sweep::Sweep(const vector<Sweep_Axis>& axes, int realizations, uint64_t seed)
+: axes(axes), realizations(realizations), seed(seed) {
+	if (realizations < 1) {
+		throw std::invalid_argument("sweep needs at least one realization");
+	}
+
+	/* Check every parameter name once on a dummy pair */
+	Cortical_Column Cortex(0);
+	CA3_Column		CA3(0);
+	for (const Sweep_Axis& axis : axes) {
+		const std::string param = axis.name.size() > 2 ? axis.name.substr(2) : "";
+		const bool known = (axis.name.compare(0, 2, "C.") == 0 && Cortex.set_param(param, 0.0)) ||
+						   (axis.name.compare(0, 2, "H.") == 0 && CA3.set_param(param, 0.0));
+		if (!known) {
+			throw std::invalid_argument("unknown sweep parameter " + axis.name);
+		}
+		if (axis.values.empty()) {
+			throw std::invalid_argument("sweep parameter " + axis.name + " has no values");
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Grid access 											*/
+/****************************************************************************************************/
+Sweep_Axis Sweep::parse_axis(const std::string& arg) {
+	const size_t eq = arg.find('=');
+	if (eq == std::string::npos) {
+		throw std::invalid_argument("sweep axis " + arg + " is not of the form name=values");
+	}
+
+	Sweep_Axis axis;
+	axis.name = arg.substr(0, eq);
+	const std::string values = arg.substr(eq+1);
+
+	/* Range first:step:last */
+	double first, step, last;
+	char c1, c2;
+	std::istringstream range(values);
+	if (values.find(':') != std::string::npos) {
+		if (!(range >> first >> c1 >> step >> c2 >> last) || c1 != ':' || c2 != ':' || step <= 0) {
+			throw std::invalid_argument("invalid range in sweep axis " + arg);
+		}
+		const int M = (int) std::floor((last - first)/step + 1E-9) + 1;
+		for (int i=0; i<M; ++i) {
+			axis.values.push_back(first + i*step);
+		}
+		return axis;
+	}
+
+	/* List v1,v2,... */
+	std::istringstream list(values);
+	std::string item;
+	while (std::getline(list, item, ',')) {
+		try {
+			axis.values.push_back(std::stod(item));
+		} catch (const std::exception&) {
+			throw std::invalid_argument("invalid value " + item + " in sweep axis " + arg);
+		}
+	}
+	return axis;
+}
+
+int Sweep::points(void) const {
+	int M = 1;
+	for (const Sweep_Axis& axis : axes) {
+		M *= axis.values.size();
+	}
+	return M;
+}
+
+/* The first axis varies fastest */
+double Sweep::value(int point, int axis) const {
+	for (int i=0; i<axis; ++i) {
+		point /= axes[i].values.size();
+	}
+	return axes[axis].values[point % axes[axis].values.size()];
+}
+
+void Sweep::set_spectrum(int window, double f_max) {
+	if (window > 0) {
+		/* Checks the window size */
+		Welch_PSD(window, 1.0);
+	}
+	this->window	= window;
+	this->f_max		= f_max;
+}
+
+void Sweep::set_detection(bool on, const HFO_Settings& settings) {
+	detect	= on;
+	hfo		= settings;
+}
+
+void Sweep::set_params(const Parameter_Set& params) {
+	check_params(params);
+	base = params;
+}
+
+void Sweep::set_burn_in(const std::string& directory, int states, double decorrelation) {
+	cache.reset(new Burn_In_Cache(directory, states, decorrelation));
+}
+
+Parameter_Set Sweep::params(int point) const {
+	Parameter_Set result(base);
+	for (unsigned i=0; i<axes.size(); ++i) {
+		result.push_back(std::make_pair(axes[i].name, value(point, i)));
+	}
+	return result;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 Simulation of the jobs										*/
+/****************************************************************************************************/
+Sweep_Result Sweep::run_job(int job, int T, int onset) const {
+	extern const int res;
+	Sweep_Result result;
+	result.point		= job / realizations;
+	result.realization	= job % realizations;
+
+	/* Initialize the populations */
+	Cortical_Column Cortex(seed, result.realization);
+	CA3_Column		CA3(seed, result.realization);
+
+	/* Transient, either integrated or continued from a cached state */
+	if (cache) {
+		cache->start(Cortex, CA3, params(result.point), onset, seed, result.realization);
+	} else {
+		apply_params(params(result.point), Cortex, CA3);
+		for (int t=0; t<onset*res; ++t) {
+			ODE(Cortex, CA3);
+		}
+	}
+
+	/* Accumulate mean, variance and optionally the spectra and HFO events of the output channels */
+	vector<Welch_PSD> spectra;
+	for (int c=0; c<3 && window>0; ++c) {
+		spectra.push_back(Welch_PSD(window, res));
+	}
+	extern const double dt;
+	HFO_Detector detector(dt, hfo);
+	double data[3], sum[3] = {0.0, 0.0, 0.0}, sq[3] = {0.0, 0.0, 0.0};
+	for (int t=0; t<T*res; ++t) {
+		ODE(Cortex, CA3);
+		get_data(0, Cortex, CA3, data, data+1, data+2);
+		for (int c=0; c<3; ++c) {
+			sum[c] += data[c];
+			sq [c] += data[c]*data[c];
+		}
+		for (unsigned c=0; c<spectra.size(); ++c) {
+			spectra[c].push(data[c]);
+		}
+		if (detect) {
+			detector.push(data[1]);
+		}
+	}
+	result.events = detector.events;
+	for (unsigned c=0; c<spectra.size(); ++c) {
+		result.psd[c] = spectra[c].psd(f_max);
+	}
+
+	const double L = (double) T*res;
+	for (int c=0; c<3; ++c) {
+		result.mean[c] = sum[c]/L;
+		result.std [c] = std::sqrt(std::max(0.0, sq[c]/L - result.mean[c]*result.mean[c]));
+	}
+	return result;
+}
+
+vector<Sweep_Result> Sweep::run(int T, int onset, int threads) const {
+	vector<Sweep_Result>	results(jobs());
+	std::exception_ptr		error;
+	std::mutex				error_lock;
+	Thread_Pool pool(threads);
+	for (int job=0; job<jobs(); ++job) {
+		pool.submit([this, &results, &error, &error_lock, job, T, onset] {
+			/* The cache may throw, the first error is rethrown to the caller */
+			try {
+				results[job] = run_job(job, T, onset);
+			} catch (...) {
+				std::lock_guard<std::mutex> guard(error_lock);
+				if (!error) {
+					error = std::current_exception();
+				}
+			}
+		});
+	}
+	pool.wait();
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	return results;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Output of results 										*/
+/****************************************************************************************************/
+void Sweep::write(const std::string& file, const vector<Sweep_Result>& results) const {
+	std::ofstream out(file.c_str());
+	if (!out) {
+		throw std::runtime_error("cannot open " + file);
+	}
+	out.precision(10);
+
+	out << "job,point,realization";
+	for (const Sweep_Axis& axis : axes) {
+		out << "," << axis.name;
+	}
+	out << ",mean_V_C,std_V_C,mean_V_H,std_V_H,mean_Y_H,std_Y_H\n";
+
+	for (unsigned job=0; job<results.size(); ++job) {
+		const Sweep_Result& r = results[job];
+		out << job << "," << r.point << "," << r.realization;
+		for (unsigned i=0; i<axes.size(); ++i) {
+			out << "," << value(r.point, i);
+		}
+		for (int c=0; c<3; ++c) {
+			out << "," << r.mean[c] << "," << r.std[c];
+		}
+		out << "\n";
+	}
+}
+
+void Sweep::write_spectra(const std::string& file, const vector<Sweep_Result>& results) const {
+	std::ofstream out(file.c_str());
+	if (!out) {
+		throw std::runtime_error("cannot open " + file);
+	}
+	out.precision(10);
+
+	extern const int res;
+	const char*		names[3] = {"V_C", "V_H", "Y_H"};
+	const Welch_PSD	bins(window, res);
+	out << "job,point,realization,channel";
+	for (int k=0; k<bins.bins(f_max); ++k) {
+		out << "," << bins.frequency(k);
+	}
+	out << "\n";
+
+	for (unsigned job=0; job<results.size(); ++job) {
+		const Sweep_Result& r = results[job];
+		for (int c=0; c<3; ++c) {
+			out << job << "," << r.point << "," << r.realization << "," << names[c];
+			for (double P : r.psd[c]) {
+				out << "," << P;
+			}
+			out << "\n";
+		}
+	}
+}
+
+void Sweep::write_events(const std::string& file, const vector<Sweep_Result>& results) const {
+	std::ofstream out(file.c_str());
+	if (!out) {
+		throw std::runtime_error("cannot open " + file);
+	}
+	out.precision(10);
+
+	out << "job,point,realization";
+	for (const Sweep_Axis& axis : axes) {
+		out << "," << axis.name;
+	}
+	out << ",onset_ms,duration_ms,frequency_Hz,amplitude,cycles\n";
+
+	for (unsigned job=0; job<results.size(); ++job) {
+		const Sweep_Result& r = results[job];
+		for (const HFO_Event& e : r.events) {
+			out << job << "," << r.point << "," << r.realization;
+			for (unsigned i=0; i<axes.size(); ++i) {
+				out << "," << value(r.point, i);
+			}
+			out << "," << e.onset << "," << e.duration << "," << e.frequency
+				<< "," << e.amplitude << "," << e.cycles << "\n";
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,143 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Parameter sweeps											*/
+/*																									*/
+/*		A sweep is the cartesian product of several parameter axes. Every point of the grid is		*/
+/*		simulated with a number of realizations, and every (point, realization) pair is an			*/
+/*		independent job that is scheduled on a work-stealing thread pool. The noise is keyed by		*/
+/*		(seed, realization), so that different points are compared under common noise and any		*/
+/*		single job can be reproduced on its own.													*/
+/****************************************************************************************************/
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "Burn_In.h"
+#include "CA3_Column.h"
+#include "Cortical_Column.h"
+#include "HFO_Detector.h"
+using std::vector;
+
+/****************************************************************************************************/
+/*										Sweep description											*/
+/****************************************************************************************************/
+/* A single parameter axis, the name is "C.<param>" for the cortex and "H.<param>" for CA3 */
+struct Sweep_Axis {
+	std::string		name;
+	vector<double>	values;
+};
+
+/* Summary statistics of a single job for the channels V_C, V_H and Y_H, the power spectral	*/
+/* densities and the HFO events of V_H are only computed if enabled							*/
+struct Sweep_Result {
+	int					point		= 0;
+	uint32_t			realization	= 0;
+	double				mean[3]	= {0.0, 0.0, 0.0};
+	double				std [3]	= {0.0, 0.0, 0.0};
+	vector<double>		psd [3];
+	vector<HFO_Event>	events;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Implementation of a sweep									*/
+/****************************************************************************************************/
+class Sweep {
+public:
+	/* Constructors, throws std::invalid_argument for unknown parameters */
+	Sweep(const vector<Sweep_Axis>& axes, int realizations, uint64_t seed = 0);
+
+	/* Parse an axis of the form "C.N_pp=100,200,300" or "H.input=0:0.5:2" (first:step:last) */
+	static Sweep_Axis parse_axis (const std::string& arg);
+
+	/* Size of the grid */
+	int		points	(void) const;
+	int		jobs	(void) const {return points()*realizations;}
+
+	/* Value of an axis at a grid point */
+	double	value	(int point, int axis) const;
+
+	/* Accumulate Welch spectra with the given window (power of two) up to f_max in Hz, 0 disables */
+	void	set_spectrum	(int window, double f_max = 400);
+
+	/* Detect HFO events in V_H */
+	void	set_detection	(bool on, const HFO_Settings& settings = HFO_Settings());
+
+	/* Parameters of every grid point, the axes override them. Throws std::invalid_argument for	*/
+	/* unknown parameters																			*/
+	void	set_params		(const Parameter_Set& params);
+
+	/* Start the jobs from cached burned in states instead of integrating the onset every time,	*/
+	/* see Burn_In.h. An empty directory keeps the states in memory only						*/
+	void	set_burn_in		(const std::string& directory, int states, double decorrelation);
+
+	/* Run all jobs for T seconds after an onset of the given length on the given number of threads.	*/
+	/* The first exception of a job, e.g. of the cache, is rethrown once all jobs are finished		*/
+	vector<Sweep_Result> run (int T, int onset, int threads) const;
+
+	/* Simulation of a single job, e.g. on a worker process, see Shard.h */
+	Sweep_Result run_job (int job, int T, int onset) const;
+
+	/* Write the results as CSV, one line per job */
+	void	write	(const std::string& file, const vector<Sweep_Result>& results) const;
+
+	/* Write the spectra as CSV, one line per job and channel with one column per frequency */
+	void	write_spectra	(const std::string& file, const vector<Sweep_Result>& results) const;
+
+	/* Write the HFO events as CSV, one line per event */
+	void	write_events	(const std::string& file, const vector<Sweep_Result>& results) const;
+
+private:
+	/* Parameters of a grid point */
+	Parameter_Set	params	(int point) const;
+
+	vector<Sweep_Axis>	axes;
+	Parameter_Set		base;
+	const int			realizations;
+	const uint64_t		seed;
+
+	/* Settings of the spectra */
+	int					window	= 0;
+	double				f_max	= 400;
+
+	/* Settings of the HFO detection */
+	bool				detect	= false;
+	HFO_Settings		hfo;
+
+	/* Optional cache of burned in states */
+	std::shared_ptr<Burn_In_Cache>	cache;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,210 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ */
+
+/****************************************************************************************************/
+/*									Work-stealing thread pool										*/
+/*																									*/
+/*		Every worker owns a task queue. Workers take tasks from the back of their own queue and,	*/
+/*		once it is empty, steal from the front of the other queues. Tasks submitted from outside	*/
+/*		the pool are distributed round robin, tasks submitted by a worker go to its own queue.		*/
+/*		Thereby there is no single global queue all threads contend for.							*/
+/****************************************************************************************************/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Thread_Pool {
+public:
+	typedef std::function<void(void)> Task;
+
+	/* Constructors */
+	explicit Thread_Pool(int N = 0)
+	: pending(0), queued(0), next(0), stop(false) {
+		if (N <= 0) {
+			N = std::max(1u, std::thread::hardware_concurrency());
+		}
+		for (int i=0; i<N; ++i) {
+			queues.push_back(std::unique_ptr<Task_Queue>(new Task_Queue));
+		}
+		for (int i=0; i<N; ++i) {
+			threads.push_back(std::thread(&Thread_Pool::work, this, i));
+		}
+	}
+
+	~Thread_Pool() {
+		drain();
+		{
+			std::lock_guard<std::mutex> guard(sleep_lock);
+			stop = true;
+		}
+		wake.notify_all();
+		for (auto& t : threads) {
+			t.join();
+		}
+	}
+
+	/* Number of worker threads */
+	int		size	(void) const {return threads.size();}
+
+	/* Add a task to the pool */
+	void	submit	(Task task) {
+		const int self = worker_id(this);
+		const int id   = self >= 0 ? self : next++ % queues.size();
+		++pending;
+		{
+			std::lock_guard<std::mutex> guard(queues[id]->lock);
+			queues[id]->tasks.push_back(std::move(task));
+		}
+		++queued;
+		{
+			std::lock_guard<std::mutex> guard(sleep_lock);
+		}
+		wake.notify_one();
+	}
+
+	/* Block until all submitted tasks are finished. If tasks threw, the first exception is		*/
+	/* rethrown here, the remaining tasks still run												*/
+	void	wait	(void) {
+		drain();
+		std::exception_ptr first;
+		{
+			std::lock_guard<std::mutex> guard(sleep_lock);
+			std::swap(first, error);
+		}
+		if (first) {
+			std::rethrow_exception(first);
+		}
+	}
+
+private:
+	/* Queue of a single worker */
+	struct Task_Queue {
+		std::mutex			lock;
+		std::deque<Task>	tasks;
+	};
+
+	/* Index of the calling thread within pool, -1 for foreign threads */
+	static int& worker_id(const Thread_Pool* pool) {
+		static thread_local const Thread_Pool*	owner	= nullptr;
+		static thread_local int					id		= -1;
+		if (owner != pool) {
+			owner	= pool;
+			id		= -1;
+		}
+		return id;
+	}
+
+	/* Take the newest task of the own queue */
+	bool	pop		(int id, Task& task) {
+		std::lock_guard<std::mutex> guard(queues[id]->lock);
+		if (queues[id]->tasks.empty()) {
+			return false;
+		}
+		task = std::move(queues[id]->tasks.back());
+		queues[id]->tasks.pop_back();
+		return true;
+	}
+
+	/* Take the oldest task of another queue */
+	bool	steal	(int id, Task& task) {
+		const int N = queues.size();
+		for (int i=1; i<N; ++i) {
+			Task_Queue& victim = *queues[(id+i) % N];
+			std::unique_lock<std::mutex> guard(victim.lock, std::try_to_lock);
+			if (guard.owns_lock() && !victim.tasks.empty()) {
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* Block until all submitted tasks are finished */
+	void	drain	(void) {
+		std::unique_lock<std::mutex> guard(sleep_lock);
+		done.wait(guard, [this]{return pending == 0;});
+	}
+
+	/* Run a task, the first exception is kept for wait */
+	void	run		(Task& task) {
+		try {
+			task();
+		} catch (...) {
+			std::lock_guard<std::mutex> guard(sleep_lock);
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	}
+
+	/* Main loop of a worker */
+	void	work	(int id) {
+		worker_id(this) = id;
+		Task task;
+		while (true) {
+			if (pop(id, task) || steal(id, task)) {
+				--queued;
+				run(task);
+				task = nullptr;
+				if (--pending == 0) {
+					std::lock_guard<std::mutex> guard(sleep_lock);
+					done.notify_all();
+				}
+				continue;
+			}
+			std::unique_lock<std::mutex> guard(sleep_lock);
+			wake.wait(guard, [this]{return stop || queued > 0;});
+			if (stop && queued == 0) {
+				return;
+			}
+		}
+	}
+
+	std::vector<std::unique_ptr<Task_Queue>>	queues;
+	std::vector<std::thread>					threads;
+
+	/* Tasks submitted but not finished, tasks waiting in a queue */
+	std::atomic<int>		pending, queued;
+	std::atomic<unsigned>	next;
+	bool					stop;
+
+	/* Sleeping of idle workers and waiting for completion */
+	std::mutex				sleep_lock;
+	std::condition_variable	wake, done;
+
+	/* First exception of a task since the last wait */
+	std::exception_ptr		error;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
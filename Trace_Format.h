@@ -0,0 +1,82 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Trace file format											*/
+/*																									*/
+/*		A trace file is laid out such that it can be memory mapped and read in place:				*/
+/*			Trace_File_Header		fixed size header												*/
+/*			metadata				C times (uint32 length, channel name),							*/
+/*									P times (uint32 length, parameter name, double value)			*/
+/*			chunks					from data_offset on, every chunk holds a run of consecutive		*/
+/*									frames in columnar order, i.e. all values of channel 0, then	*/
+/*									all of channel 1 and so on, every column padded to 64 bytes		*/
+/*			index					from index_offset on, one Trace_Chunk per chunk in time order	*/
+/*																									*/
+/*		All values are in native byte order. The data, every column of a chunk and the index		*/
+/*		start at multiples of 64 bytes, so every channel of a chunk is an aligned array of doubles,	*/
+/*		whatever the number of frames of the chunk. The header is finalized on close, files with	*/
+/*		index_offset == 0 were not closed properly.													*/
+/****************************************************************************************************/
+#pragma once
+#include <cstdint>
+
+/* Fixed header at the start of the file */
+struct Trace_File_Header {
+	char		magic[8];			/* "NMHFOTRC"								*/
+	uint32_t	version;			/* Format version							*/
+	uint32_t	channels;			/* Number of channels C						*/
+	uint32_t	chunk;				/* Frames per chunk, the last may be shorter	*/
+	uint32_t	params;				/* Number of parameters P					*/
+	double		dt;					/* Time step in ms							*/
+	uint64_t	seed;				/* Seed of the noise streams				*/
+	uint64_t	frames;				/* Total number of frames					*/
+	uint64_t	chunks;				/* Number of chunks							*/
+	uint64_t	index_offset;		/* File offset of the chunk index			*/
+	uint64_t	data_offset;		/* File offset of the first chunk			*/
+};
+
+/* Entry of the time index, channel c of the chunk starts at offset + c*trace_column_bytes(frames) */
+struct Trace_Chunk {
+	uint64_t	first;				/* Index of the first frame					*/
+	uint64_t	frames;				/* Number of frames							*/
+	uint64_t	offset;				/* File offset of the chunk					*/
+};
+
+static const char		trace_magic[8]	= {'N', 'M', 'H', 'F', 'O', 'T', 'R', 'C'};
+static const uint32_t	trace_version	= 3;
+static const uint64_t	trace_alignment	= 64;
+
+/* Bytes of a column of frames doubles including the padding to the alignment */
+inline uint64_t trace_column_bytes(uint64_t frames) {
+	return (frames*sizeof(double) + trace_alignment - 1) / trace_alignment * trace_alignment;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,205 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Implementation of the memory mapped trace reader					*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Trace_Reader.h"
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+/* Reads a length prefixed string of the metadata block */
+static std::string read_string(const char* base, uint64_t length, uint64_t& position) {
+	uint32_t size;
+	if (position + sizeof(size) > length) {
+		throw std::runtime_error("Trace_Reader: truncated metadata");
+	}
+	std::memcpy(&size, base + position, sizeof(size));
+	position += sizeof(size);
+	if (position + size > length) {
+		throw std::runtime_error("Trace_Reader: truncated metadata");
+	}
+	position += size;
+	return std::string(base + position - size, size);
+}
+
+Trace_Reader::Trace_Reader(const std::string& file) {
+	const int fd = ::open(file.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("Trace_Reader: cannot open " + file);
+	}
+	struct stat info;
+	if (::fstat(fd, &info) != 0 || (uint64_t) info.st_size < sizeof(Trace_File_Header)) {
+		::close(fd);
+		throw std::runtime_error("Trace_Reader: " + file + " is no trace");
+	}
+	length	= info.st_size;
+	void* p	= ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) {
+		throw std::runtime_error("Trace_Reader: cannot map " + file);
+	}
+	base	= static_cast<const char*>(p);
+	header	= reinterpret_cast<const Trace_File_Header*>(base);
+
+	/* Check the header before anything is dereferenced */
+	const char* error = nullptr;
+	if (std::memcmp(header->magic, trace_magic, sizeof(trace_magic)) || header->version != trace_version) {
+		error = " is no trace";
+	} else if (header->index_offset == 0) {
+		error = " was not closed";
+	} else if (header->index_offset % trace_alignment || header->data_offset % trace_alignment ||
+			   header->index_offset > length ||
+			   header->chunks > (length - header->index_offset)/sizeof(Trace_Chunk)) {
+		error = " is truncated";
+	}
+	if (error) {
+		::munmap(const_cast<char*>(base), length);
+		throw std::runtime_error("Trace_Reader: " + file + error);
+	}
+	index = reinterpret_cast<const Trace_Chunk*>(base + header->index_offset);
+
+	try {
+		/* Every chunk has to lie within the file and the chunks have to cover the frames in order */
+		uint64_t frames = 0;
+		for (uint64_t k=0; k<header->chunks; ++k) {
+			const Trace_Chunk& chunk = index[k];
+			if (chunk.first != frames || chunk.offset % trace_alignment || chunk.offset > length ||
+				chunk.frames > (length - chunk.offset)/sizeof(double) ||
+				header->channels > (length - chunk.offset)/std::max<uint64_t>(trace_column_bytes(chunk.frames), 1) ||
+				chunk.frames > header->frames - frames) {
+				throw std::runtime_error("Trace_Reader: " + file + " has a corrupt index");
+			}
+			frames += chunk.frames;
+		}
+		if (frames != header->frames) {
+			throw std::runtime_error("Trace_Reader: " + file + " has a corrupt index");
+		}
+
+		uint64_t position = sizeof(Trace_File_Header);
+		for (uint32_t c=0; c<header->channels; ++c) {
+			channel_names.push_back(read_string(base, length, position));
+		}
+		for (uint32_t i=0; i<header->params; ++i) {
+			const std::string name = read_string(base, length, position);
+			double value;
+			if (position + sizeof(value) > length) {
+				throw std::runtime_error("Trace_Reader: truncated metadata");
+			}
+			std::memcpy(&value, base + position, sizeof(value));
+			position += sizeof(value);
+			parameters.push_back(std::make_pair(name, value));
+		}
+	} catch (...) {
+		::munmap(const_cast<char*>(base), length);
+		throw;
+	}
+}
+
+Trace_Reader::~Trace_Reader() {
+	::munmap(const_cast<char*>(base), length);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Random access 											*/
+/****************************************************************************************************/
+int Trace_Reader::channel(const std::string& name) const {
+	for (unsigned c=0; c<channel_names.size(); ++c) {
+		if (channel_names[c] == name) {
+			return c;
+		}
+	}
+	return -1;
+}
+
+/* Binary search for the last chunk starting at or before frame n */
+uint64_t Trace_Reader::find_chunk(uint64_t n) const {
+	uint64_t lo = 0, hi = header->chunks;
+	while (hi - lo > 1) {
+		const uint64_t mid = lo + (hi - lo)/2;
+		if (index[mid].first <= n) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+vector<Trace_Segment> Trace_Reader::segments(int c, uint64_t first, uint64_t count) const {
+	vector<Trace_Segment> result;
+	if (c < 0 || c >= channels() || first >= frames()) {
+		return result;
+	}
+	const uint64_t last = first + std::min(count, frames() - first);
+	for (uint64_t k=find_chunk(first); k<header->chunks && index[k].first < last; ++k) {
+		const Trace_Chunk&	chunk	= index[k];
+		const uint64_t		begin	= std::max(first, chunk.first);
+		const uint64_t		end		= std::min(last,  chunk.first + chunk.frames);
+		const double*		column	= reinterpret_cast<const double*>(base + chunk.offset + c*trace_column_bytes(chunk.frames));
+
+		Trace_Segment segment;
+		segment.first	= begin;
+		segment.data	= column + (begin - chunk.first);
+		segment.size	= end - begin;
+		result.push_back(segment);
+	}
+	return result;
+}
+
+vector<Trace_Segment> Trace_Reader::window(int c, double t0, double t1) const {
+	const double	n0	= std::max(0.0, std::ceil(t0/dt()));
+	const double	n1	= std::max(n0,  std::ceil(t1/dt()));
+	return segments(c, (uint64_t) n0, (uint64_t) (n1 - n0));
+}
+
+uint64_t Trace_Reader::read(int c, uint64_t first, uint64_t count, double* out) const {
+	uint64_t n = 0;
+	for (const auto& segment : segments(c, first, count)) {
+		std::memcpy(out + n, segment.data, segment.size*sizeof(double));
+		n += segment.size;
+	}
+	return n;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,106 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Memory mapped trace reader									*/
+/*																									*/
+/*		Maps a trace file written by Trace_Writer into memory and hands out views into the			*/
+/*		mapping. A time window of a single channel is located via the chunk index and only the		*/
+/*		pages of that channel within the touched chunks are ever read from disk.					*/
+/****************************************************************************************************/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Trace_Format.h"
+using std::vector;
+
+/****************************************************************************************************/
+/*										View of a trace segment										*/
+/****************************************************************************************************/
+/* Contiguous values of one channel for the frames [first, first + size) */
+struct Trace_Segment {
+	uint64_t		first	= 0;
+	const double*	data	= nullptr;
+	uint64_t		size	= 0;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Implementation of the trace reader								*/
+/****************************************************************************************************/
+class Trace_Reader {
+public:
+	/* Constructors, throws std::runtime_error if the file is no complete trace */
+	explicit Trace_Reader(const std::string& file);
+	~Trace_Reader();
+
+	Trace_Reader(const Trace_Reader&)				= delete;
+	Trace_Reader& operator=(const Trace_Reader&)	= delete;
+
+	/* Description of the trace */
+	int			channels	(void) const {return header->channels;}
+	uint64_t	frames		(void) const {return header->frames;}
+	double		dt			(void) const {return header->dt;}
+	uint64_t	seed		(void) const {return header->seed;}
+	const vector<std::string>&						names	(void) const {return channel_names;}
+	const vector<std::pair<std::string, double>>&	params	(void) const {return parameters;}
+
+	/* Index of a channel by name, -1 if there is none */
+	int			channel		(const std::string& name) const;
+
+	/* Views of channel c for the frames [first, first + count), one per touched chunk. The count	*/
+	/* is clamped to the end of the trace, an invalid c or first >= frames() give no segments		*/
+	vector<Trace_Segment>	segments	(int c, uint64_t first, uint64_t count) const;
+
+	/* Views of channel c for the time window [t0, t1) in ms */
+	vector<Trace_Segment>	window		(int c, double t0, double t1) const;
+
+	/* Copies the frames [first, first + count) of channel c to out, returns the number of values */
+	uint64_t				read		(int c, uint64_t first, uint64_t count, double* out) const;
+
+private:
+	/* Index of the chunk holding frame n */
+	uint64_t	find_chunk	(uint64_t n) const;
+
+	const char*					base	= nullptr;
+	uint64_t					length	= 0;
+	const Trace_File_Header*	header	= nullptr;
+	const Trace_Chunk*			index	= nullptr;
+
+	vector<std::string>							channel_names;
+	vector<std::pair<std::string, double>>		parameters;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
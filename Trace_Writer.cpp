@@ -0,0 +1,196 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Implementation of the streaming trace writer						*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include "Trace_Writer.h"
+
+/****************************************************************************************************/
+/*											Header											 		*/
+/****************************************************************************************************/
+static void write_string(std::FILE* out, const std::string& s) {
+	const uint32_t length = s.size();
+	std::fwrite(&length, sizeof(length), 1, out);
+	std::fwrite(s.data(), 1, length, out);
+}
+
+/* Zero padding up to the next multiple of the trace alignment */
+static uint64_t write_padding(std::FILE* out) {
+	const char		zeros[trace_alignment] = {};
+	const uint64_t	position = std::ftell(out);
+	const uint64_t	padding	 = (trace_alignment - position % trace_alignment) % trace_alignment;
+	std::fwrite(zeros, 1, padding, out);
+	return position + padding;
+}
+
+Trace_Writer::Trace_Writer(const std::string& file, const Trace_Header& info, int capacity, int chunk)
+: out		(std::fopen(file.c_str(), "wb")),
+  C			(info.channels.size()),
+  capacity	(std::max(capacity, 1)),
+  chunk		(std::min(std::max(chunk, 1), std::max(capacity, 1))),
+  header	(),
+  ring		(this->capacity*C),
+  column	(this->chunk),
+  head		(0),
+  tail		(0),
+  closing	(false) {
+	if (!out) {
+		throw std::runtime_error("Trace_Writer: cannot create " + file);
+	}
+	if (C == 0) {
+		std::fclose(out);
+		throw std::runtime_error("Trace_Writer: no channels given");
+	}
+
+	/* Preliminary header, completed on close */
+	std::memcpy(header.magic, trace_magic, sizeof(trace_magic));
+	header.version	= trace_version;
+	header.channels	= C;
+	header.chunk	= this->chunk;
+	header.params	= info.params.size();
+	header.dt		= info.dt;
+	header.seed		= info.seed;
+	std::fwrite(&header, sizeof(header), 1, out);
+
+	for (const auto& name : info.channels) {
+		write_string(out, name);
+	}
+	for (const auto& p : info.params) {
+		write_string(out, p.first);
+		std::fwrite(&p.second, sizeof(p.second), 1, out);
+	}
+	header.data_offset = write_padding(out);
+
+	worker = std::thread(&Trace_Writer::drain, this);
+}
+
+/* Errors are only reported by an explicit close() */
+Trace_Writer::~Trace_Writer() {
+	try {
+		close();
+	} catch (const std::runtime_error&) {}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Producer side												*/
+/****************************************************************************************************/
+void Trace_Writer::push(const double* frame) {
+	const uint64_t n = head.load(std::memory_order_relaxed);
+
+	/* Wait for the background thread only if the buffer is full */
+	if (n - tail.load(std::memory_order_acquire) == capacity) {
+		++stalled;
+		while (n - tail.load(std::memory_order_acquire) == capacity) {
+			std::this_thread::yield();
+		}
+	}
+
+	std::memcpy(&ring[(n % capacity)*C], frame, C*sizeof(double));
+	head.store(n+1, std::memory_order_release);
+}
+
+void Trace_Writer::close(void) {
+	if (!worker.joinable()) {
+		return;
+	}
+	closing.store(true, std::memory_order_release);
+	worker.join();
+
+	/* Time index behind the last chunk and the final header */
+	header.frames		= head.load();
+	header.chunks		= index.size();
+	header.index_offset	= write_padding(out);
+	if (!index.empty() &&
+		std::fwrite(&index[0], sizeof(Trace_Chunk), index.size(), out) != index.size()) {
+		failed = true;
+	}
+	std::fseek(out, 0, SEEK_SET);
+	std::fwrite(&header, sizeof(header), 1, out);
+	failed = std::fclose(out) != 0 || failed;
+	out = nullptr;
+	if (failed) {
+		throw std::runtime_error("Trace_Writer: writing the trace failed");
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										Consumer side												*/
+/****************************************************************************************************/
+void Trace_Writer::drain(void) {
+	while (true) {
+		/* Read closing first, so that no frame pushed before close() is missed */
+		const bool		last	= closing.load(std::memory_order_acquire);
+		const uint64_t	n		= head.load(std::memory_order_acquire);
+		const uint64_t	t		= tail.load(std::memory_order_relaxed);
+
+		if (n - t >= chunk || (last && n > t)) {
+			write(t, std::min(n, t + chunk));
+		} else if (last) {
+			return;
+		} else {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+}
+
+void Trace_Writer::write(uint64_t from, uint64_t to) {
+	Trace_Chunk entry;
+	entry.first		= from;
+	entry.frames	= to - from;
+	entry.offset	= write_padding(out);
+
+	/* Transpose the frames into one aligned column per channel */
+	for (int c=0; c<C; ++c) {
+		for (uint64_t n=from; n<to; ++n) {
+			column[n-from] = ring[(n % capacity)*C + c];
+		}
+		if (std::fwrite(&column[0], sizeof(double), entry.frames, out) != entry.frames) {
+			failed = true;
+		}
+		write_padding(out);
+	}
+	index.push_back(entry);
+	tail.store(to, std::memory_order_release);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
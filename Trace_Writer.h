@@ -0,0 +1,121 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*										Streaming trace writer										*/
+/*																									*/
+/*		Samples are pushed into a lock-free single-producer single-consumer ring buffer. A			*/
+/*		background thread drains the buffer chunk by chunk into a trace file, see Trace_Format.h.	*/
+/*		Thereby the memory use is independent of the simulated time apart from the chunk index,	*/
+/*		and the integrator only waits if the disk falls so far behind that the buffer is full.		*/
+/****************************************************************************************************/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Trace_Format.h"
+using std::vector;
+
+/****************************************************************************************************/
+/*										Trace description											*/
+/****************************************************************************************************/
+struct Trace_Header {
+	vector<std::string>							channels;
+	double										dt		= 0.0;
+	uint64_t									seed	= 0;
+	vector<std::pair<std::string, double>>		params;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*									Implementation of the trace writer								*/
+/****************************************************************************************************/
+class Trace_Writer {
+public:
+	/* Constructors, throws std::runtime_error if the file cannot be created. The ring buffer holds	*/
+	/* capacity frames, the background thread writes a chunk whenever chunk frames are available	*/
+	Trace_Writer(const std::string& file, const Trace_Header& header,
+				 int capacity = 1<<16, int chunk = 1<<12);
+	~Trace_Writer();
+
+	Trace_Writer(const Trace_Writer&)				= delete;
+	Trace_Writer& operator=(const Trace_Writer&)	= delete;
+
+	/* Append one frame of channels() values, must only be called from a single thread */
+	void		push		(const double* frame);
+
+	/* Flush all frames, finalize the header and stop the background thread */
+	void		close		(void);
+
+	/* Number of channels and frames pushed so far */
+	int			channels	(void) const {return C;}
+	uint64_t	frames		(void) const {return head.load(std::memory_order_relaxed);}
+
+	/* Number of pushes that had to wait for the background thread */
+	uint64_t	stalls		(void) const {return stalled;}
+
+private:
+	/* Loop of the background thread */
+	void		drain		(void);
+
+	/* Write frames [from, to) of the ring buffer to the file as one chunk */
+	void		write		(uint64_t from, uint64_t to);
+
+	std::FILE*				out;
+	const int				C;
+	const uint64_t			capacity;
+	const uint64_t			chunk;
+	Trace_File_Header		header;
+
+	/* Ring buffer, frame n is stored at (n % capacity)*C */
+	vector<double>			ring;
+
+	/* Staging buffer of a single channel and the time index of the written chunks */
+	vector<double>			column;
+	vector<Trace_Chunk>		index;
+
+	/* Frames pushed by the producer and frames written by the consumer */
+	std::atomic<uint64_t>	head;
+	std::atomic<uint64_t>	tail;
+	std::atomic<bool>		closing;
+	uint64_t				stalled		= 0;
+	bool					failed		= false;
+
+	std::thread				worker;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,698 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Validation of the fast numerical paths								*/
+/****************************************************************************************************/
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Adaptive_Integrator.h"
+#include "Data_Storage.h"
+#include "HFO_Detector.h"
+#include "Models.h"
+#include "ODE.h"
+#include "Parameters.h"
+#include "Sigmoid.h"
+#include "Welch.h"
+
+/****************************************************************************************************/
+/*								Accuracy of a single sigmoid kernel									*/
+/****************************************************************************************************/
+inline double sigmoid_kernel_error(Sigmoid_Mode mode, int M = 1<<20) {
+	/* Arguments spanning the full clamping range */
+	std::vector<double> u(M), Q_ref(M), Q(M);
+	for (int i=0; i<M; ++i) {
+		u[i] = -708.0 + 1417.0 * i / (M-1);
+	}
+
+	const Sigmoid_Mode old = get_sigmoid_mode();
+	set_sigmoid_mode(SIGMOID_LIBM);
+	sigmoid(1.0, &u[0], &Q_ref[0], M);
+	set_sigmoid_mode(mode);
+	sigmoid(1.0, &u[0], &Q[0], M);
+	set_sigmoid_mode(old);
+
+	double err = 0.0;
+	for (int i=0; i<M; ++i) {
+		if (Q_ref[i] > 0) {
+			err = std::max(err, std::abs(Q[i] - Q_ref[i]) / Q_ref[i]);
+		}
+	}
+	return err;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*								Drift of two runs with common noise									*/
+/*		Accumulates the deviations of the output channels (V_C, V_H, Y_H) of a run from the			*/
+/*		reference as well as their mean and standard deviation in both runs.						*/
+/****************************************************************************************************/
+struct Channel_Drift {
+	double max_dev[3] = {0}, sq_dev[3] = {0};
+	double sum_ref[3] = {0}, sq_ref[3] = {0}, sum_fast[3] = {0}, sq_fast[3] = {0};
+	long   n		  = 0;
+
+	void push(const double* ref, const double* fast) {
+		for (int c=0; c<3; ++c) {
+			const double d = fast[c] - ref[c];
+			max_dev[c]   = std::max(max_dev[c], std::abs(d));
+			sq_dev[c]	+= d*d;
+			sum_ref[c]	+= ref[c];
+			sq_ref[c]	+= ref[c]*ref[c];
+			sum_fast[c]	+= fast[c];
+			sq_fast[c]	+= fast[c]*fast[c];
+		}
+		++n;
+	}
+
+	void print(std::ostream& out) const {
+		const double	L			= (double) n;
+		const char*		names[3]	= {"V_C", "V_H", "Y_H"};
+		for (int c=0; c<3; ++c) {
+			const double m_ref	= sum_ref[c]/L,		s_ref  = std::sqrt(std::max(0.0, sq_ref[c]/L  - m_ref*m_ref));
+			const double m_fast	= sum_fast[c]/L,	s_fast = std::sqrt(std::max(0.0, sq_fast[c]/L - m_fast*m_fast));
+			out << names[c]
+				<< ": max |dev| " 	<< max_dev[c]
+				<< ", rms dev "		<< std::sqrt(sq_dev[c]/L)
+				<< ", mean "		<< m_ref << " / " << m_fast
+				<< ", std "			<< s_ref << " / " << s_fast << "\n";
+		}
+	}
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*							Drift of the fast sigmoid over a full run								*/
+/*		Two ensembles with identical seeds are integrated for T seconds, one with the libm			*/
+/*		reference and one with the requested kernel.												*/
+/****************************************************************************************************/
+inline void validate_sigmoid(Sigmoid_Mode mode, int T, int R, uint64_t seed) {
+	extern const int res;
+	const Sigmoid_Mode old = get_sigmoid_mode();
+
+	Cortical_Ensemble	C_ref(R, seed);
+	CA3_Ensemble		H_ref(R, seed);
+	Cortical_Ensemble	C_fast(R, seed);
+	CA3_Ensemble		H_fast(R, seed);
+
+	Channel_Drift	drift;
+	double			ref[3], fast[3];
+	for (int t=0; t<T*res; ++t) {
+		set_sigmoid_mode(SIGMOID_LIBM);
+		ODE(C_ref, H_ref);
+		set_sigmoid_mode(mode);
+		ODE(C_fast, H_fast);
+
+		for (int r=0; r<R; ++r) {
+			get_data(0, r, C_ref,  H_ref,  ref,  ref+1,  ref+2);
+			get_data(0, r, C_fast, H_fast, fast, fast+1, fast+2);
+			drift.push(ref, fast);
+		}
+	}
+	const Sigmoid_Mode used = get_sigmoid_mode();
+	set_sigmoid_mode(old);
+
+	std::cout << "sigmoid kernel " << sigmoid_mode_name(used) << " vs libm, "
+			  << T << " s, " << R << " realizations, seed " << seed << "\n";
+	std::cout << "max relative error of the firing rates: " << sigmoid_kernel_error(used) << "\n";
+	drift.print(std::cout);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*								Accuracy of the reduced precisions									*/
+/*		An ensemble in the requested precision is integrated alongside the double precision			*/
+/*		reference with identical seeds and the current sigmoid kernel. The noise is generated in	*/
+/*		double precision, so both see the same draws up to rounding to float.						*/
+/****************************************************************************************************/
+template <typename T, typename S>
+inline void compare_precision(Channel_Drift& drift, uint64_t seed, int T_sim, int R) {
+	extern const int res;
+	Cortical_Ensemble			C_ref(R, seed);
+	CA3_Ensemble				H_ref(R, seed);
+	Cortical_Ensemble_T<T, S>	C(R, seed);
+	CA3_Ensemble_T<T, S>		H(R, seed);
+
+	double ref[3], low[3];
+	for (int t=0; t<T_sim*res; ++t) {
+		ODE(C_ref, H_ref);
+		ODE(C, H);
+		for (int r=0; r<R; ++r) {
+			get_data(0, r, C_ref, H_ref, ref, ref+1, ref+2);
+			get_data(0, r, C,	  H,	 low, low+1, low+2);
+			drift.push(ref, low);
+		}
+	}
+}
+
+inline void validate_precision(Precision p, int T, int R, uint64_t seed) {
+	Channel_Drift	drift;
+	switch (p) {
+	case PRECISION_FLOAT:	compare_precision<float, float >(drift, seed, T, R); break;
+	case PRECISION_MIXED:	compare_precision<float, double>(drift, seed, T, R); break;
+	default:				compare_precision<double, double>(drift, seed, T, R); break;
+	}
+	std::cout << "precision " << precision_name(p) << " vs double, sigmoid kernel "
+			  << sigmoid_mode_name(get_sigmoid_mode()) << ", " << T << " s, " << R << " realizations, seed "
+			  << seed << "\n";
+	drift.print(std::cout);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*							Accuracy of the exponential integrator									*/
+/*		R pairs of columns with identical seeds are integrated, one with SRK4 at dt and one with	*/
+/*		the exponential integrator at k*dt. Both consume the same noise, so the deviations are		*/
+/*		those of the paths. The SRK4 run is sampled at every kth step and the first second, the		*/
+/*		relaxation from the initial state, is not compared. The columns run at the parameters P,	*/
+/*		see hfo_params. Within the bursts the paths are chaotic, so the deviations grow with T and	*/
+/*		bound the error of single realizations, validate_equivalence compares the statistics.		*/
+/****************************************************************************************************/
+inline void validate_exponential(int k, int T, int R, uint64_t seed, const Parameter_Set& P) {
+	extern const int res;
+	typedef std::chrono::high_resolution_clock Clock;
+	Channel_Drift	drift;
+	double			approx[3];
+	double			t_ref = 0.0, t_exp = 0.0;
+	for (int r=0; r<R; ++r) {
+		Cortical_Column C_ref(seed, r), C_exp(seed, r);
+		CA3_Column		H_ref(seed, r), H_exp(seed, r);
+		apply_params(P, C_ref, H_ref);
+		apply_params(P, C_exp, H_exp);
+		C_exp.set_exponential(k);
+		H_exp.set_exponential(k);
+
+		/* The reference frames are stored, so that both runs can be timed separately */
+		vector<double> frames(3 * (T*res/k));
+		auto start = Clock::now();
+		for (int t=0; t<T*res/k; ++t) {
+			for (int j=0; j<k; ++j) {
+				ODE(C_ref, H_ref);
+			}
+			get_data(0, C_ref, H_ref, &frames[3*t], &frames[3*t+1], &frames[3*t+2]);
+		}
+		auto stop = Clock::now();
+		t_ref += std::chrono::duration<double>(stop - start).count();
+
+		start = Clock::now();
+		for (int t=0; t<T*res/k; ++t) {
+			ODE_exponential(C_exp, H_exp);
+			get_data(0, C_exp, H_exp, approx, approx+1, approx+2);
+			if (t >= res/k) {
+				drift.push(&frames[3*t], approx);
+			}
+		}
+		stop = Clock::now();
+		t_exp += std::chrono::duration<double>(stop - start).count();
+	}
+
+	std::cout << "exponential integrator at " << k << " dt vs SRK4 at dt, " << T << " s, "
+			  << R << " realizations, seed " << seed << ", " << P.size() << " parameters set\n";
+	std::cout << "SRK4 " << t_ref << " s, exponential " << t_exp << " s, speedup " << t_ref / t_exp << "\n";
+	drift.print(std::cout);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*							Accuracy of the adaptive integrator										*/
+/*		As validate_exponential, with the adaptive integrator at absolute tolerance atol. The		*/
+/*		output of both runs is compared on the grid of dt.											*/
+/****************************************************************************************************/
+inline void validate_adaptive(double atol, int T, int R, uint64_t seed, const Parameter_Set& P) {
+	extern const int res;
+	typedef std::chrono::high_resolution_clock Clock;
+	Channel_Drift	drift;
+	double			t_ref = 0.0, t_ada = 0.0;
+	long			accepted = 0, rejected = 0;
+	for (int r=0; r<R; ++r) {
+		Cortical_Column C_ref(seed, r), C_ada(seed, r);
+		CA3_Column		H_ref(seed, r), H_ada(seed, r);
+		apply_params(P, C_ref, H_ref);
+		apply_params(P, C_ada, H_ada);
+
+		vector<double> frames(3 * T*res);
+		auto start = Clock::now();
+		for (int t=0; t<T*res; ++t) {
+			ODE(C_ref, H_ref);
+			get_data(0, C_ref, H_ref, &frames[3*t], &frames[3*t+1], &frames[3*t+2]);
+		}
+		auto stop = Clock::now();
+		t_ref += std::chrono::duration<double>(stop - start).count();
+
+		start = Clock::now();
+		Adaptive_Integrator A(C_ada, H_ada, atol);
+		double frame[3];
+		for (long t=0; t<T*res; ) {
+			t += A.step(T*res - t, frame);
+			if (t > res) {
+				drift.push(&frames[3*(t-1)], frame);
+			}
+		}
+		stop = Clock::now();
+		t_ada		+= std::chrono::duration<double>(stop - start).count();
+		accepted	+= A.accepted();
+		rejected	+= A.rejected();
+	}
+
+	std::cout << "adaptive integrator at atol " << atol << " vs SRK4 at dt, " << T << " s, "
+			  << R << " realizations, seed " << seed << ", " << P.size() << " parameters set\n";
+	std::cout << accepted << " accepted and " << rejected << " rejected steps, mean step "
+			  << (double) T*res*R / accepted << " dt\n";
+	std::cout << "SRK4 " << t_ref << " s, adaptive " << t_ada << " s, speedup " << t_ref / t_ada << "\n";
+	drift.print(std::cout);
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*							Ensembles generated from the model descriptions							*/
+/*		The hand written ensembles and those generated from Models.h are integrated with identical	*/
+/*		seeds. The states agree bit by bit, so only the rounding of the output sums remains.		*/
+/*		Returns whether the deviations stay within that rounding.									*/
+/****************************************************************************************************/
+inline bool validate_model(int T, int R, uint64_t seed) {
+	extern const int res;
+	typedef std::chrono::high_resolution_clock Clock;
+	Channel_Drift			drift;
+	Cortical_Ensemble		C_ref(R, seed);
+	CA3_Ensemble			H_ref(R, seed);
+	Cortical_Model_Ensemble	C_mod(R, seed);
+	CA3_Model_Ensemble		H_mod(R, seed);
+
+	double ref[3], mod[3];
+	double t_ref = 0.0, t_mod = 0.0;
+	for (int t=0; t<T*res; ++t) {
+		auto start = Clock::now();
+		ODE(C_ref, H_ref);
+		auto mid = Clock::now();
+		ODE(C_mod, H_mod);
+		auto stop = Clock::now();
+		t_ref += std::chrono::duration<double>(mid - start).count();
+		t_mod += std::chrono::duration<double>(stop - mid).count();
+		for (int r=0; r<R; ++r) {
+			get_data(0, r, C_ref, H_ref, ref, ref+1, ref+2);
+			C_mod.get_data(r, mod);
+			H_mod.get_data(r, mod+1);
+			drift.push(ref, mod);
+		}
+	}
+
+	std::cout << "model ensembles vs hand written ensembles, " << T << " s, " << R << " realizations, seed "
+			  << seed << "\n";
+	std::cout << "hand written " << t_ref << " s, generated " << t_mod << " s, speedup " << t_ref / t_mod << "\n";
+	drift.print(std::cout);
+	return drift.max_dev[0] < 1E-12 && drift.max_dev[1] == 0.0 && drift.max_dev[2] == 0.0;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*								Summary statistics of a single run									*/
+/****************************************************************************************************/
+struct Run_Summary {
+	enum {MEAN_VC, VAR_VC, MEAN_VH, VAR_VH, POWER_LOW, POWER_RIPPLE, POWER_FAST, HFO_RATE, count};
+	double value[count];
+
+	static const char* name(int i) {
+		static const char* names[count] = {"mean V_C", "var V_C", "mean V_H", "var V_H",
+										   "V_H power 1-80 Hz", "V_H power 80-250 Hz",
+										   "V_H power 250-500 Hz", "HFO rate in 1/s"};
+		return names[i];
+	}
+};
+
+/* Accumulates the summary of the channels V_C and V_H sample by sample */
+class Run_Statistics {
+public:
+	Run_Statistics(void)
+	: spectrum(1024, sample_rate()), detector(time_step()) {}
+
+	/* Frames resampled between the steps of an integrator are not computed, they only enter the	*/
+	/* spectrum and the detector																*/
+	void push(double V_C, double V_H, bool computed = true) {
+		if (computed) {
+			sum[0] += V_C;	sq[0] += V_C*V_C;
+			sum[1] += V_H;	sq[1] += V_H*V_H;
+			++n;
+		}
+		spectrum.push(V_H);
+		detector.push(V_H);
+		++frames;
+	}
+
+	Run_Summary summary(void) const {
+		Run_Summary S;
+		S.value[Run_Summary::MEAN_VC]	= sum[0]/n;
+		S.value[Run_Summary::VAR_VC]	= sq[0]/n - sum[0]/n*sum[0]/n;
+		S.value[Run_Summary::MEAN_VH]	= sum[1]/n;
+		S.value[Run_Summary::VAR_VH]	= sq[1]/n - sum[1]/n*sum[1]/n;
+
+		/* Band powers as sum of the spectrum over the band */
+		const vector<double> P = spectrum.psd(500);
+		double band[3] = {0.0, 0.0, 0.0};
+		for (unsigned k=0; k<P.size(); ++k) {
+			const double f = spectrum.frequency(k);
+			band[f < 80 ? 0 : f < 250 ? 1 : 2] += f >= 1 ? P[k] : 0.0;
+		}
+		S.value[Run_Summary::POWER_LOW]		= band[0];
+		S.value[Run_Summary::POWER_RIPPLE]	= band[1];
+		S.value[Run_Summary::POWER_FAST]	= band[2];
+		S.value[Run_Summary::HFO_RATE]		= detector.events.size() / (frames * time_step() * 1E-3);
+		return S;
+	}
+
+private:
+	static double time_step	 (void) {extern const double dt; return dt;}
+	static double sample_rate(void) {extern const double dt; return 1E3/dt;}
+
+	double			sum[2]	= {0.0, 0.0};
+	double			sq [2]	= {0.0, 0.0};
+	long			n		= 0;
+	long			frames	= 0;
+	Welch_PSD		spectrum;
+	HFO_Detector	detector;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*								Numerical paths under comparison									*/
+/*		Every path simulates the realizations [0, R) of a seed at the parameters P for an onset		*/
+/*		of one second and T seconds of recording and returns the summary of every realization.		*/
+/*		The reference is the scalar column pair with the libm sigmoid, new fast paths are added		*/
+/*		to equivalence_paths. The resolution is the relative accuracy of the arithmetic of a		*/
+/*		path, differences below it are not considered a divergence.									*/
+/****************************************************************************************************/
+struct Equivalence_Path {
+	std::string		name;
+	std::function<void(const Parameter_Set& P, uint64_t seed, int R, int T,
+					   vector<Run_Summary>& out)>	run;
+	double			resolution;
+};
+
+/* At the default parameters CA3 rests and the statistics of V_H test nothing. Here it bursts	*/
+/* intermittently around 185 Hz, a few detected events in ten seconds of a realization		*/
+inline Parameter_Set hfo_params(void) {
+	return {{"H.gamma_fA", 0.095},	{"H.G_fA", 14},		{"H.N_ff", 0},
+			{"H.N_pp", 365},		{"H.theta_p", 4.8},	{"H.N_fp", 15.5},
+			{"H.N_pf", 330},		{"H.theta_f", 0.6},	{"H.dphi", 0.5}};
+}
+
+/* Scalar columns, one realization after the other */
+inline void run_columns(Sigmoid_Mode mode, const Parameter_Set& P, uint64_t seed, int R, int T,
+						vector<Run_Summary>& out) {
+	extern const int res;
+	const Sigmoid_Mode old = get_sigmoid_mode();
+	set_sigmoid_mode(mode);
+	for (int r=0; r<R; ++r) {
+		Cortical_Column	C(seed, r);
+		CA3_Column		H(seed, r);
+		apply_params(P, C, H);
+		Run_Statistics	stats;
+		double			V_C, V_H, Y_H;
+		for (int t=0; t<(1+T)*res; ++t) {
+			ODE(C, H);
+			if (t >= res) {
+				get_data(0, C, H, &V_C, &V_H, &Y_H);
+				stats.push(V_C, V_H);
+			}
+		}
+		out.push_back(stats.summary());
+	}
+	set_sigmoid_mode(old);
+}
+
+/* Scalar columns with the exponential integrator at steps of k*dt. The output is resampled onto	*/
+/* the grid of dt, as the detector band does not fit below the Nyquist frequency of coarse steps.	*/
+/* The resampling is cubic Hermite with the slopes of the output. It misses the noise within a	*/
+/* step, so the moments are taken at the steps only											*/
+inline void run_exponential(Sigmoid_Mode mode, int k, const Parameter_Set& P, uint64_t seed, int R, int T,
+							vector<Run_Summary>& out) {
+	extern const int res;
+	extern const double dt;
+	const Sigmoid_Mode old = get_sigmoid_mode();
+	set_sigmoid_mode(mode);
+	for (int r=0; r<R; ++r) {
+		Cortical_Column	C(seed, r);
+		CA3_Column		H(seed, r);
+		apply_params(P, C, H);
+		C.set_exponential(k);
+		H.set_exponential(k);
+		Run_Statistics	stats;
+		/* Values and slopes of (V_C, V_H) at the start and the end of a step */
+		double			start[4], end[4], Y_H;
+		auto sample = [&](double* v) {
+			C.get_data (0, v);
+			C.get_slope(v+2);
+			H.get_data (0, v+1, &Y_H);
+			H.get_slope(v+3, &Y_H);
+		};
+		sample(start);
+		for (int t=0; t<(1+T)*res/k; ++t) {
+			ODE_exponential(C, H);
+			sample(end);
+			for (int i=1; i<=k; ++i) {
+				const double s = (double) i / k;
+				double frame[2];
+				for (int c=0; c<2; ++c) {
+					frame[c] = start[c] * (2*s*s*s - 3*s*s + 1) + start[c+2] * k*dt * (s*s*s - 2*s*s + s)
+							 + end  [c] * (3*s*s - 2*s*s*s)		+ end  [c+2] * k*dt * (s*s*s - s*s);
+				}
+				if (t*k + i > res) {
+					stats.push(frame[0], frame[1], i == k);
+				}
+			}
+			std::copy(end, end+4, start);
+		}
+		out.push_back(stats.summary());
+	}
+	set_sigmoid_mode(old);
+}
+
+/* Scalar columns with the adaptive integrator at absolute tolerance atol, output on the grid of dt */
+inline void run_adaptive(Sigmoid_Mode mode, double atol, const Parameter_Set& P, uint64_t seed, int R, int T,
+						 vector<Run_Summary>& out) {
+	extern const int res;
+	const Sigmoid_Mode old = get_sigmoid_mode();
+	set_sigmoid_mode(mode);
+	for (int r=0; r<R; ++r) {
+		Cortical_Column	C(seed, r);
+		CA3_Column		H(seed, r);
+		apply_params(P, C, H);
+		Run_Statistics	stats;
+		long			t = 0;
+		Adaptive_Integrator A(C, H, atol);
+		A.run((long) (1+T)*res, 1, [&](const double* frame) {
+			if (t++ >= res) {
+				stats.push(frame[0], frame[1]);
+			}
+		});
+		out.push_back(stats.summary());
+	}
+	set_sigmoid_mode(old);
+}
+
+/* All realizations at once as ensemble in the precision (T, S) */
+template <typename T, typename S>
+inline void run_ensembles(Sigmoid_Mode mode, const Parameter_Set& P, uint64_t seed, int R, int T_sim,
+						  vector<Run_Summary>& out) {
+	extern const int res;
+	const Sigmoid_Mode old = get_sigmoid_mode();
+	set_sigmoid_mode(mode);
+	Cortical_Ensemble_T<T, S>	C(R, seed);
+	CA3_Ensemble_T<T, S>		H(R, seed);
+	apply_params(P, C, H);
+	vector<Run_Statistics>	stats(R);
+	double					V_C, V_H, Y_H;
+	for (int t=0; t<(1+T_sim)*res; ++t) {
+		ODE(C, H);
+		for (int r=0; t>=res && r<R; ++r) {
+			get_data(0, r, C, H, &V_C, &V_H, &Y_H);
+			stats[r].push(V_C, V_H);
+		}
+	}
+	for (int r=0; r<R; ++r) {
+		out.push_back(stats[r].summary());
+	}
+	set_sigmoid_mode(old);
+}
+
+inline vector<Equivalence_Path> equivalence_paths(void) {
+	using namespace std::placeholders;
+	return {
+		{"scalar, libm sigmoid",	std::bind(run_columns,					 SIGMOID_LIBM, _1, _2, _3, _4, _5), 1E-9},
+		{"scalar, fast sigmoid",	std::bind(run_columns,					 SIGMOID_AUTO, _1, _2, _3, _4, _5), 1E-9},
+		{"ensemble, fast sigmoid",	std::bind(run_ensembles<double, double>, SIGMOID_AUTO, _1, _2, _3, _4, _5), 1E-9},
+		{"ensemble float, fast",	std::bind(run_ensembles<float,	float>,	 SIGMOID_AUTO, _1, _2, _3, _4, _5), 1E-6},
+		{"ensemble mixed, fast",	std::bind(run_ensembles<float,	double>, SIGMOID_AUTO, _1, _2, _3, _4, _5), 1E-6},
+		/* Fixed steps up to PSP_Propagator::max_fixed_substeps */
+		{"exponential 2 dt, fast",	std::bind(run_exponential, SIGMOID_AUTO, 2,	 _1, _2, _3, _4, _5), 1E-2},
+		{"exponential 4 dt, fast",	std::bind(run_exponential, SIGMOID_AUTO, 4,	 _1, _2, _3, _4, _5), 1E-2},
+		/* Error control shortens the steps within bursts */
+		{"adaptive 1E-2, fast",		std::bind(run_adaptive,	   SIGMOID_AUTO, 1E-2, _1, _2, _3, _4, _5), 1E-2},
+		{"adaptive 1E-3, fast",		std::bind(run_adaptive,	   SIGMOID_AUTO, 1E-3, _1, _2, _3, _4, _5), 1E-3}
+	};
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*								Statistical equivalence of the paths								*/
+/*		The paths run with common noise, so the realizations are paired. A statistic diverges if	*/
+/*		the two-sample Kolmogorov-Smirnov test rejects equal distributions at the Bonferroni		*/
+/*		corrected level alpha, or if the mean paired difference exceeds tolerance standard			*/
+/*		deviations of the reference and is significant at that level. Chaotic trajectories			*/
+/*		decorrelate over a run, so the mean difference alone scatters with the sample size.			*/
+/*		Returns true if no path diverges. Fails if the reference detects no HFO at the				*/
+/*		parameters, as then the statistics of V_H test nothing.										*/
+/****************************************************************************************************/
+/* Asymptotic p-value of the two-sample Kolmogorov-Smirnov statistic D of samples of size n and m */
+inline double ks_p_value(double D, int n, int m) {
+	const double en		= std::sqrt((double) n*m/(n+m));
+	const double lambda	= (en + 0.12 + 0.11/en) * D;
+	double p = 0.0, sign = 1.0;
+	for (int j=1; j<=100; ++j) {
+		const double term = sign * 2 * std::exp(-2 * j*j * lambda*lambda);
+		p	 += term;
+		sign  = -sign;
+		if (std::abs(term) < 1E-12) {
+			break;
+		}
+	}
+	return lambda < 1E-3 ? 1.0 : std::min(1.0, std::max(0.0, p));
+}
+
+inline double ks_statistic(vector<double> a, vector<double> b) {
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+	double D = 0.0;
+	unsigned i = 0, j = 0;
+	while (i < a.size() && j < b.size()) {
+		const double x = std::min(a[i], b[j]);
+		while (i < a.size() && a[i] <= x) {++i;}
+		while (j < b.size() && b[j] <= x) {++j;}
+		D = std::max(D, std::abs((double) i/a.size() - (double) j/b.size()));
+	}
+	return D;
+}
+
+inline bool validate_equivalence(int T, int R, uint64_t seed, const Parameter_Set& P = hfo_params(),
+								 double alpha = 0.01, double tolerance = 0.2) {
+	vector<Equivalence_Path> paths = equivalence_paths();
+	vector<Run_Summary> ref;
+	paths[0].run(P, seed, R, T, ref);
+
+	const int	tests	= (paths.size()-1) * Run_Summary::count;
+	bool		passed	= true;
+	std::cout << "equivalence against " << paths[0].name << ", " << R << " realizations of "
+			  << T << " s, seed " << seed << "\n";
+
+	double rate = 0.0;
+	for (int r=0; r<R; ++r) {
+		rate += ref[r].value[Run_Summary::HFO_RATE]/R;
+	}
+	if (rate == 0.0) {
+		std::cout << "the reference detects no HFO, choose parameters or a duration with events\n";
+		return false;
+	}
+
+	for (unsigned p=1; p<paths.size(); ++p) {
+		vector<Run_Summary> fast;
+		paths[p].run(P, seed, R, T, fast);
+		std::cout << paths[p].name << "\n";
+		for (int s=0; s<Run_Summary::count; ++s) {
+			vector<double> a(R), b(R);
+			double mean = 0.0, diff = 0.0;
+			for (int r=0; r<R; ++r) {
+				a[r]  = ref [r].value[s];
+				b[r]  = fast[r].value[s];
+				mean += a[r]/R;
+				diff += (b[r] - a[r])/R;
+			}
+			double var = 0.0, var_diff = 0.0;
+			for (int r=0; r<R; ++r) {
+				var		 += (a[r] - mean)*(a[r] - mean)/std::max(1, R-1);
+				var_diff += (b[r] - a[r] - diff)*(b[r] - a[r] - diff)/std::max(1, R-1);
+			}
+
+			/* Statistics with a spread below the resolution of the path have to match up to rounding */
+			const double floor	= std::max(paths[p].resolution * std::abs(mean), 1E-9 * std::max(1.0, std::abs(mean)));
+			const double scale	= std::max(std::sqrt(var), floor);
+			const double effect	= std::abs(diff)/scale;
+			const double pval	= std::sqrt(var) > floor ? ks_p_value(ks_statistic(a, b), R, R) : 1.0;
+			/* Paired difference against its standard error in normal approximation */
+			const double p_diff	= std::sqrt(var) > floor && var_diff > 0
+								? std::erfc(std::abs(diff)/std::sqrt(2*var_diff/R)) : 0.0;
+			const bool	 ok		= pval >= alpha/tests && (effect <= tolerance || p_diff >= alpha/tests);
+			passed = passed && ok;
+
+			char line[192];
+			std::snprintf(line, sizeof(line),
+						  "  %-22s mean %12.5g  diff %10.3g  effect %8.3g  p %6.3f  KS p %6.3f  %s\n",
+						  Run_Summary::name(s), mean, diff, effect, p_diff, pval, ok ? "ok" : "DIVERGED");
+			std::cout << line;
+		}
+	}
+	std::cout << (passed ? "all paths equivalent\n" : "some paths diverged\n");
+	return passed;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
@@ -0,0 +1,171 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*								Implementation of the Welch estimator								*/
+/****************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "Welch.h"
+
+/****************************************************************************************************/
+/*										 	Constructor 											*/
+/****************************************************************************************************/
+/* Checks the arguments before any work array is allocated, returns the window */
+static int checked_window(int window, double overlap) {
+	if (window < 2 || (window & (window-1))) {
+		throw std::invalid_argument("Welch_PSD: window has to be a power of two");
+	}
+	if (!(overlap >= 0.0 && overlap < 1.0)) {
+		throw std::invalid_argument("Welch_PSD: overlap has to be in [0, 1)");
+	}
+	return window;
+}
+
+Welch_PSD::Welch_PSD(int window, double fs, double overlap)
+: N		(checked_window(window, overlap)),
+  hop	(std::max(1, (int) std::lround(window*(1.0 - overlap)))),
+  fs	(fs),
+  w		(window),
+  buffer(window),
+  re	(window), im (window), c (window/2), s (window/2),
+  rev	(window),
+  sum	(window/2+1, 0.0) {
+
+	/* Periodic Hann window */
+	for (int n=0; n<N; ++n) {
+		w[n] = 0.5 - 0.5*std::cos(2*M_PI*n/N);
+		U	+= w[n]*w[n];
+	}
+
+	/* Twiddle factors exp(-2 pi i k/N) */
+	for (int k=0; k<N/2; ++k) {
+		c[k] =  std::cos(2*M_PI*k/N);
+		s[k] = -std::sin(2*M_PI*k/N);
+	}
+
+	/* Bit reversed indices */
+	int bits = 0;
+	while ((1 << bits) < N) {
+		++bits;
+	}
+	for (int n=0; n<N; ++n) {
+		int r = 0;
+		for (int b=0; b<bits; ++b) {
+			r |= ((n >> b) & 1) << (bits-1-b);
+		}
+		rev[n] = r;
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Accumulation 											*/
+/****************************************************************************************************/
+void Welch_PSD::push(double x) {
+	buffer[pos] = x;
+	pos = pos+1 == N ? 0 : pos+1;
+	filled = std::min(filled+1, N);
+	++since;
+
+	/* First segment once the window is full, then every hop samples */
+	if (filled == N && (count == 0 || since >= hop)) {
+		segment();
+		since = 0;
+	}
+}
+
+void Welch_PSD::segment(void) {
+	/* Oldest sample is at pos */
+	double mean = 0.0;
+	for (int n=0; n<N; ++n) {
+		mean += buffer[n];
+	}
+	mean /= N;
+	for (int n=0; n<N; ++n) {
+		const int m = rev[n];
+		re[m] = (buffer[(pos+n) % N] - mean) * w[n];
+		im[m] = 0.0;
+	}
+	fft();
+
+	/* One-sided density, all bins but DC and Nyquist are counted twice */
+	const double scale = 1.0/(fs*U);
+	for (int k=0; k<=N/2; ++k) {
+		const double P = (re[k]*re[k] + im[k]*im[k]) * scale;
+		sum[k] += (k == 0 || k == N/2) ? P : 2*P;
+	}
+	++count;
+}
+
+/* Iterative Cooley-Tukey on bit reversed input */
+void Welch_PSD::fft(void) {
+	for (int len=2; len<=N; len*=2) {
+		const int half	= len/2;
+		const int step	= N/len;
+		for (int i=0; i<N; i+=len) {
+			for (int j=0; j<half; ++j) {
+				const double wr = c[j*step], wi = s[j*step];
+				const int	 a	= i+j, b = i+j+half;
+				const double tr = re[b]*wr - im[b]*wi;
+				const double ti = re[b]*wi + im[b]*wr;
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
+
+
+/****************************************************************************************************/
+/*										 	Output 													*/
+/****************************************************************************************************/
+int Welch_PSD::bins(double f_max) const {
+	return std::min(N/2, (int) std::floor(f_max*N/fs + 1E-9)) + 1;
+}
+
+vector<double> Welch_PSD::psd(double f_max) const {
+	vector<double> P(bins(f_max), 0.0);
+	for (unsigned k=0; k<P.size() && count>0; ++k) {
+		P[k] = sum[k]/count;
+	}
+	return P;
+}
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/
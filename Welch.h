@@ -0,0 +1,96 @@
+/*
+ *	Copyright (c) 2015 University of Lübeck
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ *
+ *	AUTHORS:	Michael Schellenberger Costa: mschellenbergercosta@gmail.com
+ *
+ *	Based on:	Computational modeling of high-frequency oscillations at the onset of neocortical
+ *				partial seizures: From 'altered structure' to 'dysfunction'
+ *				B Molaee-Ardekani, P Benquet, F Bartolomei, F Wendling.
+ *				NeuroImage 52(3):1109-1122 (2010)
+ */
+
+/****************************************************************************************************/
+/*									Streaming Welch power spectrum									*/
+/*																									*/
+/*		Samples are collected in a ring buffer of one window. Every hop samples the current			*/
+/*		window is mean corrected, multiplied with a periodic Hann window, transformed with a		*/
+/*		radix-2 FFT and its periodogram is added to a running sum. Thereby the memory is O(window)	*/
+/*		independent of the duration. The scaling is that of a one-sided power spectral density		*/
+/*		in units^2/Hz, as returned by pwelch.														*/
+/****************************************************************************************************/
+#pragma once
+#include <vector>
+using std::vector;
+
+/****************************************************************************************************/
+/*									Implementation of the estimator									*/
+/****************************************************************************************************/
+class Welch_PSD {
+public:
+	/* Constructors, window has to be a power of two, fs is the sampling rate in Hz. Throws			*/
+	/* std::invalid_argument otherwise																*/
+	Welch_PSD(int window, double fs, double overlap = 0.5);
+
+	/* Add one sample */
+	void	push		(double x);
+
+	/* Number of averaged segments */
+	int		segments	(void) const {return count;}
+
+	/* Frequency of bin k in Hz and number of bins up to f_max */
+	double	frequency	(int k) const {return k*fs/N;}
+	int		bins		(double f_max) const;
+
+	/* Averaged spectrum of the bins [0, bins(f_max)) */
+	vector<double>	psd	(double f_max) const;
+
+private:
+	/* Periodogram of the current window */
+	void	segment		(void);
+
+	/* In place radix-2 FFT of re + i im */
+	void	fft			(void);
+
+	const int		N;
+	const int		hop;
+	const double	fs;
+
+	/* Window function and its power */
+	vector<double>	w;
+	double			U		= 0.0;
+
+	/* Ring buffer of the last N samples */
+	vector<double>	buffer;
+	int				pos		= 0;
+	int				filled	= 0;
+	int				since	= 0;
+
+	/* Work arrays, twiddle factors and bit reversal of the FFT */
+	vector<double>	re, im, c, s;
+	vector<int>		rev;
+
+	/* Sum of the periodograms */
+	vector<double>	sum;
+	int				count	= 0;
+};
+/****************************************************************************************************/
+/*										 		end			 										*/
+/****************************************************************************************************/